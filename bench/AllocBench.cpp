@@ -0,0 +1,85 @@
+#include "BenchUtil.h"
+#include "Analysis/ArrayLSRemover.h"
+#include "Analysis/DCE.h"
+#include "Analysis/InterprocCall.h"
+#include "FrontEnd/ASTConstructor.h"
+#include "IR/IRConstructor.h"
+#include "RegAlloc/IGBuilder.h"
+#include "Visualizer/Visualizer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace papyrus;
+
+structlog LOGCFG = {};
+
+// Every allocation of the program goes through here. Everything runs on one
+// thread, so the count needs no synchronization.
+static std::size_t num_allocations = 0;
+
+void* operator new(std::size_t size) {
+    num_allocations++;
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+template<class F>
+void Measure(const std::string& name, F run) {
+    std::size_t before = num_allocations;
+    auto start = std::chrono::steady_clock::now();
+
+    run();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-14s %10zu allocations %8.3fs\n",
+                name.c_str(), num_allocations - before, elapsed.count());
+}
+
+/*
+ * Heap allocations per pass: operator new is replaced by one which counts
+ * the calls. The IR is built from the AST, then each pass is run once, in
+ * the order of the table, with the IR written out after ArrayLSRemover.
+ *
+ * usage: allocbench <file>
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: allocbench <file>\n");
+        return 1;
+    }
+
+    LOGCFG.level = ERROR;
+
+    std::ifstream stream;
+    auto lexer = OpenLexer(argv[1], stream);
+    ASTConstructor astconst(*lexer);
+    astconst.ConstructAST();
+
+    IRConstructor irc(astconst);
+    Measure("BuildIR", [&]() { irc.BuildIR(); });
+
+    InterprocCallAnalysis ica(irc);
+    Measure("InterprocCall", [&]() { ica.Run(); });
+
+    ArrayLSRemover als(irc);
+    Measure("ArrayLSRemover", [&]() { als.Run(); });
+
+    Visualizer viz(irc);
+    Measure("Visualizer", [&]() { viz.WriteIR("/dev/null"); });
+
+    DCE dce(irc);
+    Measure("DCE", [&]() { dce.Run(); });
+
+    IGBuilder igb(irc);
+    Measure("IGBuilder", [&]() { igb.Run(); });
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+#ifndef PAPYRUS_BENCH_UTIL_H
+#define PAPYRUS_BENCH_UTIL_H
+
+#include "FrontEnd/Lexer.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace papyrus {
+
+// Trees from before the Lexer mapped its input only read from a stream. The
+// drivers hand it one there, so that bench/compare.sh can run them on those.
+template<class L = Lexer>
+std::unique_ptr<L> OpenLexer(const std::string& file_name, std::ifstream& in) {
+    if constexpr (std::is_constructible<L, const std::string&>::value) {
+        return std::make_unique<L>(file_name);
+    } else {
+        in.open(file_name);
+        return std::make_unique<L>(in);
+    }
+}
+
+// Peak resident set size of the process so far, VmHWM in /proc/self/status
+inline long PeakRSSKiB() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::stol(line.substr(6));
+        }
+    }
+    return -1;
+}
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_BENCH_UTIL_H */
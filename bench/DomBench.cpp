@@ -0,0 +1,237 @@
+#include "BenchUtil.h"
+#include "FrontEnd/ASTConstructor.h"
+#include "IR/IRConstructor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+
+using namespace papyrus;
+
+structlog LOGCFG = {};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// The dominator computation the DominatorTree replaced: Cooper-Harvey-Kennedy
+// over a hash map, with the RPO position of a BB found by a linear search
+class OldDominators {
+public:
+    OldDominators(Function* fn, const std::vector<BI>& rpo) : fn_(fn), rpo_(rpo) {}
+
+    void Compute() {
+        for (const auto& bb_pair: fn_->BasicBlocks()) {
+            idom_[bb_pair.first] = NO_BB;
+        }
+        idom_[rpo_.front()] = rpo_.front();
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto bb_idx: rpo_) {
+                if (bb_idx == rpo_.front()) {
+                    continue;
+                }
+
+                const auto& preds = fn_->GetBB(bb_idx)->Predecessors();
+                BI new_idom = preds.front();
+                for (auto pred: preds) {
+                    if (pred != new_idom && idom_[pred] != NO_BB) {
+                        new_idom = Intersect(pred, new_idom);
+                    }
+                }
+
+                if (idom_[bb_idx] != new_idom) {
+                    idom_[bb_idx] = new_idom;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    BI IDom(BI bb_idx) { return idom_[bb_idx]; }
+
+private:
+    Function* fn_;
+    const std::vector<BI>& rpo_;
+    std::unordered_map<BI, BI> idom_;
+
+    long Position(BI bb_idx) const {
+        return std::find(rpo_.begin(), rpo_.end(), bb_idx) - rpo_.begin();
+    }
+
+    BI Intersect(BI bb_1, BI bb_2) {
+        long pos_1 = Position(bb_1);
+        long pos_2 = Position(bb_2);
+        while (bb_1 != bb_2) {
+            while (pos_1 > pos_2) {
+                bb_1 = idom_[bb_1];
+                pos_1 = Position(bb_1);
+            }
+            while (pos_2 > pos_1) {
+                bb_2 = idom_[bb_2];
+                pos_2 = Position(bb_2);
+            }
+        }
+        return bb_1;
+    }
+};
+
+// Dominator sets by the textbook data-flow iteration, quadratic in space
+bool CheckAgainstDominatorSets(Function* fn, const DominatorTree& dom_tree) {
+    const auto& rpo = dom_tree.ReversePostOrder();
+    std::set<BI> reachable(rpo.begin(), rpo.end());
+
+    std::map<BI, std::set<BI> > doms;
+    for (auto bb_idx: rpo) {
+        doms[bb_idx] = bb_idx == rpo.front() ? std::set<BI>{bb_idx} : reachable;
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto bb_idx: rpo) {
+            if (bb_idx == rpo.front()) {
+                continue;
+            }
+
+            std::set<BI> current;
+            bool first = true;
+            for (auto pred: fn->GetBB(bb_idx)->Predecessors()) {
+                if (reachable.count(pred) == 0) {
+                    continue;
+                }
+                if (first) {
+                    current = doms[pred];
+                    first = false;
+                } else {
+                    std::set<BI> meet;
+                    for (auto dom: current) {
+                        if (doms[pred].count(dom) != 0) {
+                            meet.insert(dom);
+                        }
+                    }
+                    current = std::move(meet);
+                }
+            }
+
+            current.insert(bb_idx);
+            if (current != doms[bb_idx]) {
+                doms[bb_idx] = std::move(current);
+                changed = true;
+            }
+        }
+    }
+
+    for (auto dom: rpo) {
+        for (auto bb_idx: rpo) {
+            if (dom_tree.Dominates(dom, bb_idx) != (doms[bb_idx].count(dom) != 0)) {
+                std::printf("  Dominates(%d, %d) is wrong\n", dom, bb_idx);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+/*
+ * Dominator tree construction and queries, for every function with more
+ * than 1000 BBs: the time to build the DominatorTree, and the time for 1M
+ * Dominates() queries on pseudo-random pairs of BBs.
+ *
+ *   --old    also times the computation the DominatorTree replaced, and
+ *            checks that both agree on every immediate dominator
+ *   --check  checks Dominates() for every pair of BBs against dominator
+ *            sets; only for small inputs, it takes quadratic memory
+ *
+ * usage: dombench <file> [--old] [--check]
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: dombench <file> [--old] [--check]\n");
+        return 1;
+    }
+
+    LOGCFG.level = ERROR;
+
+    bool old = false;
+    bool check = false;
+    for (int i = 2; i < argc; i++) {
+        old   = old   || std::strcmp(argv[i], "--old") == 0;
+        check = check || std::strcmp(argv[i], "--check") == 0;
+    }
+
+    std::ifstream stream;
+    auto lexer = OpenLexer(argv[1], stream);
+    ASTConstructor astconst(*lexer);
+    astconst.ConstructAST();
+
+    IRConstructor irc(astconst);
+    irc.BuildIR();
+
+    const std::size_t NUM_QUERIES = 1000000;
+
+    for (const auto& fn_pair: irc.Functions()) {
+        if (irc.IsIntrinsic(fn_pair.first)) {
+            continue;
+        }
+        Function* fn = fn_pair.second;
+
+        auto start = Clock::now();
+        const auto& dom_tree = fn->Dominators();
+        double build = SecondsSince(start);
+
+        const auto& rpo = dom_tree.ReversePostOrder();
+
+        std::size_t dominated = 0;
+        start = Clock::now();
+        for (std::size_t query = 0; query < NUM_QUERIES; query++) {
+            dominated += dom_tree.Dominates(rpo[(query * 7919) % rpo.size()],
+                                            rpo[(query * 104729) % rpo.size()]);
+        }
+        double queries = SecondsSince(start);
+
+        double old_build = 0;
+        if (old) {
+            OldDominators old_doms(fn, rpo);
+            start = Clock::now();
+            old_doms.Compute();
+            old_build = SecondsSince(start);
+
+            for (auto bb_idx: rpo) {
+                if (bb_idx != rpo.front() && old_doms.IDom(bb_idx) != dom_tree.IDom(bb_idx)) {
+                    std::printf("%s: the immediate dominators of BB_%d differ\n",
+                                fn_pair.first.c_str(), bb_idx);
+                    return 1;
+                }
+            }
+        }
+
+        if (check && !CheckAgainstDominatorSets(fn, dom_tree)) {
+            std::printf("%s: Dominates() disagrees with the dominator sets\n", fn_pair.first.c_str());
+            return 1;
+        }
+
+        if (fn->BasicBlocks().size() > 1000) {
+            std::printf("%s: %zu BBs, DominatorTree %.4fs", fn_pair.first.c_str(),
+                        fn->BasicBlocks().size(), build);
+            if (old) {
+                std::printf(", old %.4fs", old_build);
+            }
+            std::printf(", 1M Dominates() %.4fs (%zu true)\n", queries, dominated);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include "BenchUtil.h"
+#include "FrontEnd/ASTConstructor.h"
+#include "IR/IRConstructor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace papyrus;
+
+structlog LOGCFG = {};
+
+/*
+ * IR construction time: the input is parsed, then the IR is built from the
+ * AST, which is timed. This is done several times over and the best run is
+ * reported.
+ *
+ * usage: irbench <file> [runs]
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: irbench <file> [runs]\n");
+        return 1;
+    }
+
+    LOGCFG.level = ERROR;
+    std::string file_name = argv[1];
+    int runs = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    double best = 1e30;
+
+    for (int run = 0; run < runs; run++) {
+        std::ifstream stream;
+        auto lexer = OpenLexer(file_name, stream);
+        ASTConstructor astconst(*lexer);
+        astconst.ConstructAST();
+
+        IRConstructor irc(astconst);
+
+        auto start = std::chrono::steady_clock::now();
+        irc.BuildIR();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        best = std::min(best, elapsed.count());
+    }
+
+    std::printf("BuildIR %.3fs (best of %d)\n", best, runs);
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "BenchUtil.h"
+#include "Analysis/PassManager.h"
+#include "FrontEnd/ASTConstructor.h"
+#include "IR/IRConstructor.h"
+#include "Visualizer/Visualizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <thread>
+
+using namespace papyrus;
+
+structlog LOGCFG = {};
+
+using Clock = std::chrono::steady_clock;
+
+struct JobTimes {
+    double passes;
+    double draw;
+};
+
+// Builds the IR afresh, which is not timed, then times the -O2 pipeline and
+// the drawing of the IR with the given number of jobs
+JobTimes TimeJobs(const std::string& file_name, unsigned jobs) {
+    std::ifstream stream;
+    auto lexer = OpenLexer(file_name, stream);
+    ASTConstructor astconst(*lexer);
+    astconst.ConstructAST();
+
+    IRConstructor irc(astconst);
+    irc.BuildIR();
+
+    PassManager pm(irc);
+    pm.SetJobs(jobs);
+    pm.AddPipeline(2);
+
+    auto start = Clock::now();
+    pm.Run();
+    std::chrono::duration<double> passes = Clock::now() - start;
+
+    Visualizer viz(irc);
+    viz.SetJobs(jobs);
+
+    start = Clock::now();
+    viz.WriteIR("/dev/null");
+    std::chrono::duration<double> draw = Clock::now() - start;
+
+    return {passes.count(), draw.count()};
+}
+
+/*
+ * Speedup of the function passes and of drawing with the number of jobs.
+ * For each number of jobs, the -O2 pipeline is run on a fresh IR and the IR
+ * is drawn, best of 3. The speedup is against the first number of jobs.
+ * Parsing, IR construction and the register allocator stay serial and are
+ * not included.
+ *
+ * usage: jobsbench <file> [jobs,jobs,...]   (default 1, 2, 4, ... up to the
+ *                                             number of hardware threads)
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: jobsbench <file> [jobs,jobs,...]\n");
+        return 1;
+    }
+
+    LOGCFG.level = ERROR;
+
+    std::vector<unsigned> job_counts;
+    if (argc > 2) {
+        std::stringstream list(argv[2]);
+        std::string jobs;
+        while (std::getline(list, jobs, ',')) {
+            job_counts.push_back(std::stoul(jobs));
+        }
+    } else {
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned jobs = 1; jobs < threads; jobs *= 2) {
+            job_counts.push_back(jobs);
+        }
+        job_counts.push_back(threads);
+    }
+
+    std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+
+    JobTimes first = {0, 0};
+    for (auto jobs: job_counts) {
+        JobTimes best = {1e30, 1e30};
+        for (int run = 0; run < 3; run++) {
+            JobTimes times = TimeJobs(argv[1], jobs);
+            best.passes = std::min(best.passes, times.passes);
+            best.draw   = std::min(best.draw, times.draw);
+        }
+
+        if (first.passes == 0) {
+            first = best;
+        }
+
+        std::printf("%3u jobs: passes %.3fs (%.2fx), drawing %.3fs (%.2fx)\n", jobs,
+                    best.passes, first.passes / best.passes,
+                    best.draw, first.draw / best.draw);
+    }
+
+    return 0;
+}
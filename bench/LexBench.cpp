@@ -0,0 +1,52 @@
+#include "BenchUtil.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+using namespace papyrus;
+
+structlog LOGCFG = {};
+
+/*
+ * Lexer throughput: the input is lexed several times over and the best run
+ * is reported, in tokens and bytes per second.
+ *
+ * usage: lexbench <file> [runs]
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: lexbench <file> [runs]\n");
+        return 1;
+    }
+
+    LOGCFG.level = ERROR;
+    std::string file_name = argv[1];
+    int runs = argc > 2 ? std::atoi(argv[2]) : 7;
+
+    std::ifstream in(file_name, std::ios::ate | std::ios::binary);
+    double megabytes = static_cast<double>(in.tellg()) / 1e6;
+
+    std::size_t num_tokens = 0;
+    double best = 1e30;
+
+    for (int run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+
+        std::ifstream stream;
+        auto lexer = OpenLexer(file_name, stream);
+        std::size_t tokens = 0;
+        while (lexer->GetNextToken() != Lexer::TOK_EOF) {
+            tokens++;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+        num_tokens = tokens;
+    }
+
+    std::printf("%zu tokens, %.1f MB: %.4fs, %.1f Mtok/s, %.1f MB/s (best of %d)\n",
+                num_tokens, megabytes, best, num_tokens / best / 1e6, megabytes / best, runs);
+    return 0;
+}
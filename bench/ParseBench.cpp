@@ -0,0 +1,59 @@
+#include "BenchUtil.h"
+#include "FrontEnd/ASTConstructor.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+using namespace papyrus;
+
+structlog LOGCFG = {};
+
+// Older trees allocate the nodes on the heap and have no pools to report
+template<class A, class = void>
+struct HasNodePools : std::false_type {};
+
+template<class A>
+struct HasNodePools<A, std::void_t<decltype(std::declval<A&>().Nodes().BytesAllocated())> >
+    : std::true_type {};
+
+template<class A>
+void PrintNodePools(const A& astconst) {
+    if constexpr (HasNodePools<A>::value) {
+        std::printf(", node pools %.1f MB", astconst.Nodes().BytesAllocated() / 1e6);
+    }
+}
+
+/*
+ * Parser time and memory: the input is lexed and parsed into an AST once,
+ * which is timed. Then the peak resident set size of the process (VmHWM,
+ * which includes the mapped input) is reported, along with the bytes held
+ * by the node pools on trees which have them.
+ *
+ * usage: parsebench <file>
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: parsebench <file>\n");
+        return 1;
+    }
+
+    LOGCFG.level = ERROR;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::ifstream stream;
+    auto lexer = OpenLexer(argv[1], stream);
+    ASTConstructor astconst(*lexer);
+    astconst.ConstructAST();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("parse %.3fs, peak RSS %.1f MB", elapsed.count(), PeakRSSKiB() / 1024.0);
+    PrintNodePools(astconst);
+    std::printf("\n");
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "BenchUtil.h"
+#include "FrontEnd/ASTConstructor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+using namespace papyrus;
+
+structlog LOGCFG = {};
+
+// Drives the token interface of the parser the way the productions do: peek
+// at the next token, then fetch it and read the attributes of the current one
+class TokenReader : public ASTConstructor {
+public:
+    using ASTConstructor::ASTConstructor;
+
+    std::size_t ReadAll() {
+        std::size_t checksum = 0;
+        while (PeekNextToken() != Lexer::TOK_EOF) {
+            FetchToken();
+            checksum += CurrentToken() + GetSymbol() + GetLineNo() + GetBuffer().size();
+        }
+        return checksum;
+    }
+};
+
+/*
+ * Token rate through the parser: the input is lexed alone, then read
+ * through the token interface of ASTConstructor without parsing. The best
+ * of several runs of each is reported, along with the difference per token,
+ * which is the cost of handing tokens to the parser.
+ *
+ * usage: tokenbench <file> [runs]
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: tokenbench <file> [runs]\n");
+        return 1;
+    }
+
+    LOGCFG.level = ERROR;
+    std::string file_name = argv[1];
+    int runs = argc > 2 ? std::atoi(argv[2]) : 15;
+
+    std::size_t num_tokens = 0;
+    std::size_t checksum = 0;
+    double best_lexer = 1e30;
+    double best_parser = 1e30;
+
+    for (int run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::ifstream stream;
+            auto lexer = OpenLexer(file_name, stream);
+            num_tokens = 0;
+            while (lexer->GetNextToken() != Lexer::TOK_EOF) {
+                num_tokens++;
+            }
+        }
+
+        auto middle = std::chrono::steady_clock::now();
+        {
+            std::ifstream stream;
+            auto lexer = OpenLexer(file_name, stream);
+            TokenReader reader(*lexer);
+            checksum += reader.ReadAll();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        best_lexer = std::min(best_lexer, std::chrono::duration<double>(middle - start).count());
+        best_parser = std::min(best_parser, std::chrono::duration<double>(end - middle).count());
+    }
+
+    std::printf("%zu tokens: lexer %.4fs, through the parser %.4fs, %.1f Mtok/s, "
+                "%.1f ns/token more (best of %d, checksum %zu)\n",
+                num_tokens, best_lexer, best_parser, num_tokens / best_parser / 1e6,
+                (best_parser - best_lexer) / num_tokens * 1e9, runs, checksum % 1000);
+    return 0;
+}
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Runs the benchmarks of this tree on an older revision as well, so that the
+# two can be compared. The drivers of bench/ are copied over to a worktree of
+# the revision, and those which no longer build there are skipped.
+#
+# usage: bench/compare.sh <revision> [build directory]
+set -e
+
+if [ $# -lt 1 ]; then
+    echo "usage: bench/compare.sh <revision> [build directory]" >&2
+    exit 1
+fi
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+BUILD=${2:-$ROOT/_bench_build}
+OLD=$BUILD/old
+
+rm -rf "$OLD"
+git -C "$ROOT" worktree prune
+git -C "$ROOT" worktree add --detach "$OLD/src" "$1" > /dev/null
+
+rm -rf "$OLD/src/bench"
+cp -r "$ROOT/bench" "$OLD/src/bench"
+# Older trees force a debug build, may be C++11 and do not know about bench/
+sed -i -e 's/^set(CMAKE_BUILD_TYPE debug)$//' \
+       -e 's/^set(CMAKE_CXX_STANDARD 11)$/set(CMAKE_CXX_STANDARD 17)/' \
+    "$OLD/src/CMakeLists.txt"
+grep -q "add_subdirectory(bench)" "$OLD/src/CMakeLists.txt" ||
+    echo "add_subdirectory(bench)" >> "$OLD/src/CMakeLists.txt"
+
+echo "######## $1"
+"$OLD/src/bench/run.sh" "$OLD/build" || true
+echo
+echo "######## this tree"
+"$ROOT/bench/run.sh" "$BUILD"
+
+git -C "$ROOT" worktree remove --force "$OLD/src"
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""
+Generates large PL241 programs for the benchmarks and stress tests.
+
+usage: gen_program.py <kind> <args...>
+
+  statements <vars> <statements>
+      main alone, with a long run of assignments, ifs and whiles over
+      many variables.
+  procs <procedures> <statements>
+      Many procedures with local arrays and calls between them.
+  nested <vars> <depth> <reads>
+      Loops nested depth deep. Every loop reads most variables without
+      assigning them, so every loop header starts with many phis.
+  cfg <pairs>
+      main with an if followed by a while, pairs times over, for about
+      3 BBs per pair. d is assigned before the chain and read after it,
+      so reading it walks through every block.
+  globals <count>
+      count global variables, each assigned and read by main.
+
+The output is the same for the same arguments.
+"""
+
+import random
+import sys
+
+
+def statements(num_vars, num_statements):
+    rng = random.Random(1)
+    names = ["v%d" % i for i in range(num_vars)]
+
+    def expr():
+        return "%s %s %s" % (rng.choice(names), rng.choice("+-*"),
+                             rng.choice(names + ["3", "7"]))
+
+    def assignments(count):
+        return "; ".join("let %s <- %s" % (rng.choice(names), expr())
+                         for _ in range(count))
+
+    body = ["let %s <- %d" % (name, rng.randint(0, 9)) for name in names]
+    count = 0
+    while count < num_statements:
+        kind = rng.random()
+        if kind < 0.6:
+            body.append(assignments(1))
+            count += 1
+        elif kind < 0.8:
+            body.append("if %s < %s then %s else %s fi" %
+                        (rng.choice(names), rng.choice(names),
+                         assignments(4), assignments(4)))
+            count += 8
+        else:
+            body.append("while %s < 100 do %s od" %
+                        (rng.choice(names), assignments(4)))
+            count += 4
+    body.append("call OutputNum(%s)" % names[0])
+
+    return ["main", "var %s;" % ", ".join(names), "{",
+            ";\n".join(body), "}."]
+
+
+def procs(num_procs, num_statements):
+    rng = random.Random(7)
+    names = ["x", "y", "z", "w", "a", "b"]
+
+    def expr():
+        return "%s %s %s" % (rng.choice(names), rng.choice("+-*"),
+                             rng.choice(names + ["3", "5"]))
+
+    out = ["main", "var g, h;", "array[10][4] arr;"]
+    for i in range(num_procs):
+        out += ["function f%d(a, b);" % i,
+                "var x, y, z, w; array[8] loc;",
+                "{"]
+        body = ["let x <- a + b", "let y <- a * 2",
+                "let z <- b - 1", "let w <- 0"]
+        for _ in range(num_statements):
+            kind = rng.random()
+            if kind < 0.4:
+                body.append("let %s <- %s + arr[%d][%d]" %
+                            (rng.choice("xyzw"), expr(),
+                             rng.randint(0, 9), rng.randint(0, 3)))
+            elif kind < 0.6:
+                body.append("let loc[%d] <- %s" % (rng.randint(0, 7), expr()))
+            elif kind < 0.8:
+                body.append("if %s < %s then let x <- %s; let y <- loc[%d] + %s "
+                            "else let z <- %s fi" %
+                            (rng.choice(names), rng.choice(names), expr(),
+                             rng.randint(0, 7), expr(), expr()))
+            else:
+                body.append("while w < %d do let w <- w + 1; "
+                            "let y <- y + loc[%d] * arr[1][2]; let z <- %s od" %
+                            (rng.randint(5, 50), rng.randint(0, 7), expr()))
+        if i > 0:
+            body.append("let x <- call f%d(y, z)" % rng.randint(0, i - 1))
+        body.append("return x + y + z + w")
+        out += [";\n".join(body), "};"]
+
+    out += ["{", "let g <- call f%d(1, 2);" % (num_procs - 1),
+            "call OutputNum(g)", "}."]
+    return out
+
+
+def nested(num_vars, depth, reads):
+    names = ["v%d" % i for i in range(num_vars)]
+
+    def loop(level):
+        stmts = ["let i <- i + 1"]
+        if level < depth:
+            stmts.append("while i < %d do %s od" % (100 + level, loop(level + 1)))
+        for k in range(reads):
+            stmts.append("let s <- s + %s" % names[k % num_vars])
+        return "; ".join(stmts)
+
+    body = ["let %s <- %d" % (name, k) for k, name in enumerate(names)]
+    body += ["let s <- 0", "let i <- 0", loop(0), "call OutputNum(s)"]
+
+    return ["main", "var i, s, %s;" % ", ".join(names), "{",
+            ";\n".join(body), "}."]
+
+
+def cfg(pairs):
+    out = ["main", "var a, b, c, d;", "{",
+           "let a <- 0; let b <- 0; let c <- 100; let d <- 7;"]
+    for i in range(pairs):
+        out.append("if a < b then let a <- a + %d else let b <- b + %d fi;" %
+                   (i % 7 + 1, i % 5 + 1))
+        out.append("while a < c do let a <- a + %d od;" % (i % 3 + 1))
+    out += ["call OutputNum(a + b + d)", "}."]
+    return out
+
+
+def globals_(count):
+    names = ["g%d" % i for i in range(count)]
+    body = ["let %s <- %d" % (name, i % 10) for i, name in enumerate(names)]
+    body.append("call OutputNum(%s)" % " + ".join(names[-8:]))
+
+    out = ["main"]
+    # Several short declarations rather than one very long line
+    for i in range(0, count, 100):
+        out.append("var %s;" % ", ".join(names[i:i + 100]))
+    out += ["{", ";\n".join(body), "}."]
+    return out
+
+
+KINDS = {
+    "statements": (statements, 2),
+    "procs": (procs, 2),
+    "nested": (nested, 3),
+    "cfg": (cfg, 1),
+    "globals": (globals_, 1),
+}
+
+
+def main():
+    if len(sys.argv) < 2 or sys.argv[1] not in KINDS:
+        sys.stderr.write(__doc__)
+        return 1
+
+    generate, num_args = KINDS[sys.argv[1]]
+    args = sys.argv[2:]
+    if len(args) != num_args:
+        sys.stderr.write(__doc__)
+        return 1
+
+    print("\n".join(generate(*map(int, args))))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,96 @@
+#!/bin/sh
+# Builds the benchmark drivers with optimizations and runs them on inputs
+# generated into the build directory.
+#
+# usage: bench/run.sh [build directory]
+#
+# BENCH_JOBS=1,2,4,... sets the numbers of jobs jobsbench is run with, by
+# default powers of two up to the number of hardware threads.
+#
+# bench/compare.sh runs the same benchmarks on an older revision.
+set -e
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+BUILD=${1:-$ROOT/_bench_build}
+INPUTS=$BUILD/bench_inputs
+
+cmake -S "$ROOT" -B "$BUILD" -DCMAKE_BUILD_TYPE=Release > /dev/null
+mkdir -p "$INPUTS"
+
+# Builds a driver, which may not exist in an older revision
+driver() {
+    if cmake --build "$BUILD" --target "$1" -j"$(nproc)" > "$BUILD/$1.build.log" 2>&1; then
+        return 0
+    fi
+    echo "($1 does not build in this tree, see $BUILD/$1.build.log)"
+    return 1
+}
+
+echo "== Lexer throughput, public_tests/big.txt repeated 1000 times"
+if [ ! -f "$INPUTS/big1000.txt" ]; then
+    i=0
+    while [ $i -lt 1000 ]; do
+        cat "$ROOT/public_tests/big.txt"
+        i=$((i + 1))
+    done > "$INPUTS/big1000.txt"
+fi
+if driver lexbench; then
+    "$BUILD/bench/lexbench" "$INPUTS/big1000.txt"
+fi
+
+echo "== Parser time and memory, 200 variables and 400k statements"
+if [ ! -f "$INPUTS/statements.txt" ]; then
+    python3 "$ROOT/bench/gen_program.py" statements 200 400000 > "$INPUTS/statements.txt"
+fi
+if driver parsebench; then
+    "$BUILD/bench/parsebench" "$INPUTS/statements.txt"
+fi
+
+echo "== Token rate through the parser, 20 procedures of 7500 statements"
+if [ ! -f "$INPUTS/procs.txt" ]; then
+    python3 "$ROOT/bench/gen_program.py" procs 20 7500 > "$INPUTS/procs.txt"
+fi
+if driver tokenbench; then
+    "$BUILD/bench/tokenbench" "$INPUTS/procs.txt"
+fi
+
+echo "== Heap allocations per pass, 200 procedures of 50 statements"
+if [ ! -f "$INPUTS/procs200.txt" ]; then
+    python3 "$ROOT/bench/gen_program.py" procs 200 50 > "$INPUTS/procs200.txt"
+fi
+if driver allocbench; then
+    "$BUILD/bench/allocbench" "$INPUTS/procs200.txt"
+    echo "-- public_tests/big.txt"
+    "$BUILD/bench/allocbench" "$ROOT/public_tests/big.txt"
+fi
+
+echo "== IR construction, reads of 16 variables in 20 nested loops"
+if driver irbench; then
+    for reads in 2000 4000 8000 16000; do
+        if [ ! -f "$INPUTS/nested$reads.txt" ]; then
+            python3 "$ROOT/bench/gen_program.py" nested 16 20 $reads > "$INPUTS/nested$reads.txt"
+        fi
+        printf "%6d reads per loop: " $reads
+        "$BUILD/bench/irbench" "$INPUTS/nested$reads.txt"
+    done
+fi
+
+echo "== Dominator trees, an if and a while repeated in main"
+if driver dombench; then
+    for pairs in 2000 10000 20000; do
+        if [ ! -f "$INPUTS/cfg$pairs.txt" ]; then
+            python3 "$ROOT/bench/gen_program.py" cfg $pairs > "$INPUTS/cfg$pairs.txt"
+        fi
+    done
+    "$BUILD/bench/dombench" "$INPUTS/cfg2000.txt" --old
+    "$BUILD/bench/dombench" "$INPUTS/cfg10000.txt" --old
+    "$BUILD/bench/dombench" "$INPUTS/cfg20000.txt"
+fi
+
+echo "== Function passes and drawing against the number of jobs, 2000 procedures"
+if [ ! -f "$INPUTS/procs2000.txt" ]; then
+    python3 "$ROOT/bench/gen_program.py" procs 2000 50 > "$INPUTS/procs2000.txt"
+fi
+if driver jobsbench; then
+    "$BUILD/bench/jobsbench" "$INPUTS/procs2000.txt" ${BENCH_JOBS:-}
+fi
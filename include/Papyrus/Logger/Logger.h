@@ -3,6 +3,8 @@
 
 // Code motivated from: https://stackoverflow.com/a/32262143
 #include <iostream>
+#include <optional>
+#include <sstream>
 
 enum typelog {
     DEBUG,
@@ -29,23 +31,29 @@ class LOG {
             }
         }
 
+        // The line is written out in one go, so that lines logged from
+        // several threads do not get mixed up
         ~LOG() {
-            if(opened) {
-                std::cout << std::endl;
+            if(line) {
+                *line << '\n';
+                std::cout << line->str() << std::flush;
             }
-            opened = false;
         }
 
+        // The stream is only created once something is logged at the
+        // configured level, messages below it cost a comparison
         template<class T>
             LOG &operator<<(const T &msg) {
                 if(msglevel >= LOGCFG.level) {
-                    std::cout << msg;
-                    opened = true;
+                    if(!line) {
+                        line.emplace();
+                    }
+                    *line << msg;
                 }
                 return *this;
             }
     private:
-        bool opened = false;
+        std::optional<std::ostringstream> line;
         typelog msglevel = DEBUG;
         inline std::string getLabel(typelog type) {
             std::string label;
@@ -0,0 +1,113 @@
+#ifndef PAPYRUS_THREADPOOL_H
+#define PAPYRUS_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace papyrus {
+
+/*
+ * A fixed set of worker threads running tasks from a shared queue. Submit()
+ * queues a task and Wait() blocks until every task submitted so far has
+ * finished. Tasks report their results through state they capture; the
+ * pool itself does not order or collect them.
+ */
+class ThreadPool {
+public:
+    // 0 threads picks one per hardware thread
+    explicit ThreadPool(unsigned num_threads = 0) :
+        pending_(0),
+        stopping_(false) {
+        if (num_threads == 0) {
+            num_threads = DefaultThreads();
+        }
+
+        for (unsigned i = 0; i < num_threads; i++) {
+            workers_.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        task_ready_.notify_all();
+
+        for (auto& worker: workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static unsigned DefaultThreads() {
+        unsigned hw = std::thread::hardware_concurrency();
+        return hw == 0 ? 1 : hw;
+    }
+
+    std::size_t Size() const { return workers_.size(); }
+
+    void Submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push(std::move(task));
+            pending_++;
+        }
+        task_ready_.notify_one();
+    }
+
+    void Wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        all_done_.wait(lock, [this] { return pending_ == 0; });
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()> > tasks_;
+
+    std::mutex mutex_;
+    std::condition_variable task_ready_;
+    std::condition_variable all_done_;
+
+    // Tasks submitted but not finished yet
+    std::size_t pending_;
+    bool stopping_;
+
+    void WorkerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                task_ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+
+                if (tasks_.empty()) {
+                    return;
+                }
+
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pending_--;
+                if (pending_ == 0) {
+                    all_done_.notify_all();
+                }
+            }
+        }
+    }
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_THREADPOOL_H */
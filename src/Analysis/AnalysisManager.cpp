@@ -0,0 +1,43 @@
+#include "AnalysisManager.h"
+
+using namespace papyrus;
+
+AnalysisManager::AnalysisManager(IRConstructor& irc) :
+    irc_(irc),
+    valid_(PRESERVE_NONE),
+    call_graph_(irc) {}
+
+const InterprocCallAnalysis& AnalysisManager::CallGraph() {
+    if (!IsValid(ANALYSIS_CALL_GRAPH)) {
+        call_graph_.Run();
+        valid_ |= ANALYSIS_CALL_GRAPH;
+    }
+
+    return call_graph_;
+}
+
+void AnalysisManager::RunPass(AnalysisPass& pass) {
+    pass.Run();
+    Invalidate(pass.Preserved());
+}
+
+void AnalysisManager::Invalidate(PreservedAnalyses preserved) {
+    valid_ &= preserved;
+
+    for (const auto& fn_pair: irc_.Functions()) {
+        if (irc_.IsIntrinsic(fn_pair.first) || fn_pair.second == nullptr) {
+            continue;
+        }
+
+        fn_pair.second->InvalidateAnalyses(preserved);
+    }
+}
+
+void AnalysisManager::Invalidate(Function* fn, PreservedAnalyses preserved) {
+    fn->InvalidateAnalyses(preserved);
+
+    // What the function calls may have changed
+    if (!(preserved & ANALYSIS_CALL_GRAPH)) {
+        valid_ &= ~static_cast<PreservedAnalyses>(ANALYSIS_CALL_GRAPH);
+    }
+}
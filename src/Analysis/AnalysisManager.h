@@ -0,0 +1,50 @@
+#ifndef PAPYRUS_ANALYSIS_MANAGER_H
+#define PAPYRUS_ANALYSIS_MANAGER_H
+
+#include "AnalysisPass.h"
+#include "InterprocCall.h"
+
+namespace papyrus {
+
+/*
+ * AnalysisManager hands out the analyses of a module, computing each of them
+ * once and caching it until something invalidates it.
+ *
+ * The analyses of a function (CFG orders, dominators, dominance frontiers,
+ * loops) are cached in the Function itself, which also drops them whenever
+ * its CFG is edited. The manager caches the module analyses (the call graph)
+ * on its own.
+ *
+ * Transformations are run through RunPass(), which drops every analysis the
+ * pass does not declare as preserved, in every function, so that the next
+ * pass cannot read results computed before the IR changed.
+ */
+class AnalysisManager {
+public:
+    AnalysisManager(IRConstructor&);
+
+    // Who calls whom
+    const InterprocCallAnalysis& CallGraph();
+
+    // Runs the pass, then invalidates what it did not preserve
+    void RunPass(AnalysisPass&);
+
+    void Invalidate(PreservedAnalyses);
+    void Invalidate(Function*, PreservedAnalyses);
+    // Leaves the analyses of the functions alone
+    void InvalidateModule(PreservedAnalyses preserved) { valid_ &= preserved; }
+
+    bool IsValid(AnalysisKind kind) const { return (valid_ & kind) != 0; }
+
+private:
+    IRConstructor& irc_;
+
+    // Which of the module analyses are up to date
+    PreservedAnalyses valid_;
+
+    InterprocCallAnalysis call_graph_;
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_ANALYSIS_MANAGER_H */
@@ -16,13 +16,42 @@ namespace papyrus {
 class AnalysisPass {
 public:
     AnalysisPass(IRConstructor& irc) : irc_(irc) {}
+    virtual ~AnalysisPass() {}
     virtual void Run() = 0;
 
+    // Analyses which are still valid once Run() is done. Passes which do
+    // not say otherwise are assumed to invalidate everything.
+    virtual PreservedAnalyses Preserved() const { return PRESERVE_NONE; }
+
 protected:
     IRConstructor& irc_;
     inline IRConstructor& irc() { return irc_; }
 };
 
+/*
+ * A FunctionPass looks at one function at a time, and keeps no state from
+ * one function to the next. RunOnFunction() may be called for several
+ * functions at once from different threads, so it must not create values
+ * and must only touch what belongs to the function it is given.
+ */
+class FunctionPass : public AnalysisPass {
+public:
+    FunctionPass(IRConstructor& irc) : AnalysisPass(irc) {}
+
+    // Runs on every function, one after the other
+    void Run() {
+        for (const auto& fn_pair: irc().Functions()) {
+            if (irc().IsIntrinsic(fn_pair.first)) {
+                continue;
+            }
+
+            RunOnFunction(fn_pair.second);
+        }
+    }
+
+    virtual void RunOnFunction(Function*) = 0;
+};
+
 } // namespace papyrus
 
 #endif /* PAPYRUS_ANALYSISPASS_H */
@@ -6,19 +6,34 @@
 #include <stack>
 
 namespace papyrus {
-class ArrayLSRemover : public AnalysisPass {
-public:
-    ArrayLSRemover(IRConstructor& irc) : AnalysisPass(irc) {}
-    void Run();
+// An array element is named by the array and the location value computing its
+// address, so a store can find every element of the array it clobbers
+struct LSKey {
+    bool operator==(const LSKey& other) const {
+        return symbol == other.symbol && location == other.location;
+    }
+
+    SymbolId symbol;
+    VI location;
+};
 
-private:
-    std::unordered_map<BI, std::unordered_set<std::string> > active_defs_;
-    std::unordered_map<BI, std::unordered_map<std::string, VI> > hash_val;
-    std::unordered_map<std::string, VI> all_defs_;
+struct LSKeyHash {
+    std::size_t operator()(const LSKey& key) const {
+        return std::hash<uint64_t>()((static_cast<uint64_t>(key.symbol) << 32) |
+                                     static_cast<uint32_t>(key.location));
+    }
+};
 
-    std::string LSHash(const Instruction*);
+class ArrayLSRemover : public FunctionPass {
+public:
+    ArrayLSRemover(IRConstructor& irc) : FunctionPass(irc) {}
+    void RunOnFunction(Function*);
 
+    // Only loads and stores are removed
+    PreservedAnalyses Preserved() const { return PRESERVE_CFG | ANALYSIS_CALL_GRAPH; }
 
+private:
+    LSKey LSHash(const Instruction*);
 };
 } // namespace papyrus
 
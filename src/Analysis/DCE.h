@@ -9,22 +9,23 @@ namespace papyrus {
  * Under construction
  */
 
-class DCE : public AnalysisPass {
+class DCE : public FunctionPass {
 public:
     DCE(IRConstructor&);
-    void Run();
+    void RunOnFunction(Function*);
 
-private:
-    void ProcessBlock(Function *fn, BasicBlock* bb);
-    bool CanRemove(T);
-
-    void ConstructReverseDominanceFrontier(const std::unordered_map<BI, BI>&);
+    // Calls and branches are never removed
+    PreservedAnalyses Preserved() const { return PRESERVE_CFG | ANALYSIS_CALL_GRAPH; }
 
-    std::unordered_set<BI> visited;
-    std::unordered_set<VI> non_dead;
-    std::unordered_set<II> inactive_ins;
+private:
+    // What is known about the function being processed
+    struct Liveness {
+        std::unordered_set<VI> non_dead;
+        std::unordered_set<II> inactive_ins;
+    };
 
-    std::unordered_map<BI, BI> reverse_dominance_frontier_;
+    void ProcessBlock(Function *fn, BasicBlock* bb, Liveness&);
+    bool CanRemove(T);
 };
 
 } // namespace papyrus
@@ -0,0 +1,153 @@
+#include "GVN.h"
+
+using namespace papyrus;
+
+// Moves the uses of the result of the instruction over to value, those by
+// phis included, and removes the instruction
+void GVN::Replace(Function* fn, Instruction* ins, VI value) {
+    fn->ReplaceUse(ins->Result(), value);
+    fn->RemoveInstruction(ins->Index());
+}
+
+std::size_t GVN::ProcessPhis(Function* fn, BasicBlock* bb) {
+    std::size_t removed = 0;
+
+    // Phis can only be congruent to phis of the same block
+    InstructionKeyMap<VI> block_phis;
+
+    for (auto ins_idx: bb->InstructionOrder()) {
+        auto ins = fn->GetInstruction(ins_idx);
+        // Phis may come after the kills at the top of the BB
+        if (!ins->IsPhi()) {
+            continue;
+        }
+
+        auto result = ins->Result();
+
+        // The same value flowing in from everywhere, ignoring the phi itself
+        VI same = NO_VALUE;
+        bool is_trivial = true;
+        for (auto op: ins->Operands()) {
+            if (op == result || op == same) {
+                continue;
+            }
+
+            if (same != NO_VALUE) {
+                is_trivial = false;
+                break;
+            }
+            same = op;
+        }
+
+        if (is_trivial && same != NO_VALUE) {
+            Replace(fn, ins, same);
+            removed++;
+            continue;
+        }
+
+        const auto& sources = ins->Sources();
+        if (sources.size() != 2) {
+            continue;
+        }
+
+        // Key the operands by the predecessor they flow in from
+        BI src_1 = std::min(sources[0], sources[1]);
+        BI src_2 = std::max(sources[0], sources[1]);
+        InstructionKey key(T::INS_PHI, ins->OperandFrom(src_1), ins->OperandFrom(src_2));
+
+        auto it = block_phis.find(key);
+        if (it != block_phis.end()) {
+            Replace(fn, ins, it->second);
+            removed++;
+        } else {
+            block_phis.emplace(key, result);
+        }
+    }
+
+    return removed;
+}
+
+std::size_t GVN::ProcessBlock(Function* fn, BasicBlock* bb, ScopedTable& table) {
+    std::size_t removed = ProcessPhis(fn, bb);
+
+    for (auto ins_idx: bb->InstructionOrder()) {
+        auto ins = fn->GetInstruction(ins_idx);
+        auto insty = ins->Type();
+
+        if (!fn->IsEliminable(insty)) {
+            continue;
+        }
+
+        const auto& operands = ins->Operands();
+
+        InstructionKey key;
+        if (operands.size() == 1) {
+            key = fn->HashInstruction(insty, operands[0]);
+        } else if (operands.size() == 2) {
+            key = fn->HashInstruction(insty, operands[0], operands[1]);
+        } else {
+            continue;
+        }
+
+        auto it = table.available.find(key);
+        if (it != table.available.end()) {
+            LOG(INFO) << "[GVN] Removed " << key;
+            Replace(fn, ins, it->second);
+            removed++;
+        } else {
+            table.available.emplace(key, ins->Result());
+            table.scope_keys.push_back(key);
+        }
+    }
+
+    return removed;
+}
+
+void GVN::RunOnFunction(Function* fn) {
+    const auto& dom_tree = fn->Dominators();
+
+    ScopedTable table;
+
+    // Depth-first walk of the dominator tree. Each entry remembers which of
+    // its children are still to be visited, and where its scope begins.
+    struct Scope {
+        const BI* next_child;
+        const BI* end_child;
+        std::size_t first_key;
+    };
+
+    std::size_t removed = 0;
+    std::vector<Scope> worklist;
+
+    BI entry_idx = dom_tree.Root();
+    removed += ProcessBlock(fn, fn->GetBB(entry_idx), table);
+
+    auto children = dom_tree.Children(entry_idx);
+    worklist.push_back({children.begin(), children.end(), 0});
+
+    while (!worklist.empty()) {
+        auto& scope = worklist.back();
+
+        if (scope.next_child != scope.end_child) {
+            BI child = *scope.next_child++;
+
+            std::size_t first_key = table.scope_keys.size();
+            removed += ProcessBlock(fn, fn->GetBB(child), table);
+
+            children = dom_tree.Children(child);
+            worklist.push_back({children.begin(), children.end(), first_key});
+            continue;
+        }
+
+        // Expressions of this BB are not available outside its subtree
+        while (table.scope_keys.size() > scope.first_key) {
+            table.available.erase(table.scope_keys.back());
+            table.scope_keys.pop_back();
+        }
+        worklist.pop_back();
+    }
+
+    LOG(INFO) << "[GVN] Removed " << removed << " instructions from " << fn->FunctionName();
+
+    num_removed_ += removed;
+}
@@ -0,0 +1,53 @@
+#ifndef PAPYRUS_GVN_H
+#define PAPYRUS_GVN_H
+
+#include "AnalysisPass.h"
+
+#include <atomic>
+
+namespace papyrus {
+
+/*
+ * GVN is a dominator-based global value numbering pass. It runs on the
+ * finished IR, after SSA repair and ArrayLSRemover, and catches redundancies
+ * which the on-the-fly CSE in Function::MakeInstruction could not see while
+ * the operands were still being resolved.
+ *
+ * The dominator tree is walked depth-first with a scoped hash table: an
+ * expression is available in a block only if it was computed in one of its
+ * dominators. A redundant instruction has its uses moved over to the
+ * available value and is then removed.
+ *
+ * Phis are numbered per block: a phi is congruent to an earlier phi of the
+ * same block if the same values flow in from the same predecessors, and is
+ * replaced outright if the same value flows in from every predecessor.
+ */
+class GVN : public FunctionPass {
+public:
+    GVN(IRConstructor& irc) : FunctionPass(irc), num_removed_(0) {}
+    void RunOnFunction(Function*);
+
+    // Calls are never numbered, and branches are left alone
+    PreservedAnalyses Preserved() const { return PRESERVE_CFG | ANALYSIS_CALL_GRAPH; }
+
+    // Number of instructions removed so far, from all functions
+    std::size_t NumRemoved() const { return num_removed_; }
+
+private:
+    std::atomic<std::size_t> num_removed_;
+
+    // Available expressions, and the keys to drop when leaving each scope
+    struct ScopedTable {
+        InstructionKeyMap<VI> available;
+        std::vector<InstructionKey> scope_keys;
+    };
+
+    std::size_t ProcessBlock(Function*, BasicBlock*, ScopedTable&);
+    std::size_t ProcessPhis(Function*, BasicBlock*);
+
+    void Replace(Function*, Instruction*, VI);
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_GVN_H */
@@ -1,23 +1,24 @@
 #include "GlobalClobbering.h"
+#include "AnalysisManager.h"
 
 using namespace papyrus;
 
 GlobalClobbering::GlobalClobbering(IRConstructor& irc) :
     AnalysisPass(irc) {}
 
-void GlobalClobbering::Clobber(const std::string& fn_name, const std::string& var_name) {
+void GlobalClobbering::Clobber(const std::string& fn_name, SymbolId var_name) {
     clobbered_vars_[fn_name].insert(var_name);
 }
 
-void GlobalClobbering::ReadDef(const std::string& fn_name, const std::string& var_name) {
+void GlobalClobbering::ReadDef(const std::string& fn_name, SymbolId var_name) {
     read_vars_[fn_name].insert(var_name);
 }
 
-const VarMap& GlobalClobbering::GetClobberStatus() const {
+const SymbolMap& GlobalClobbering::GetClobberStatus() const {
     return clobbered_vars_;
 }
 
-const VarMap& GlobalClobbering::GetReadDefStatus() const {
+const SymbolMap& GlobalClobbering::GetReadDefStatus() const {
     return read_vars_;
 }
 
@@ -43,21 +44,21 @@ void GlobalClobbering::Visit(const std::string& fn_name) {
                 // Perform two major checks:
                 // 1. Check if instruction is active.
                 // 2. Check if it is a store to a global variable
-                auto operands = inst->Operands();
+                const auto& operands = inst->Operands();
                 auto value_idx = operands.at(1);
                 auto val = irc().GetValue(value_idx);
 
                 // Clobber the global variable value here.
-                Clobber(fn_name, val->Identifier());
+                Clobber(fn_name, val->GetSymbol());
             } else if (inst->IsActive() && IsGlobalLoad(inst->Type())) {
                 // 1. Check if instruction is active
                 // 2. Check if it is a load from a global variable
-                auto operands = inst->Operands();
+                const auto& operands = inst->Operands();
                 auto value_idx = operands.at(0);
                 auto val = irc().GetValue(value_idx);
 
-                auto ident = val->Identifier();
-                if (ident != "") {
+                auto ident = val->GetSymbol();
+                if (ident != NO_SYMBOL) {
                     // Add ReadDef; 
                     // NOTE: ident is empty when formal params are involved.
                     ReadDef(fn_name, ident);
@@ -86,15 +87,12 @@ void GlobalClobbering::Visit(const std::string& fn_name) {
 }
 
 void GlobalClobbering::Run() {
-
-    InterprocCallAnalysis ipc(irc());
-    ipc.Run();
-    callee_info_ = ipc.GetCalleeInfo();
+    callee_info_ = irc().Analyses().CallGraph().GetCalleeInfo();
 
     // Topological Sort
     // Visit all callee's of a function before you visit itself
-    for (auto fn_pair: irc().Functions()) {
-        auto fn_name = fn_pair.first;
+    for (const auto& fn_pair: irc().Functions()) {
+        const auto& fn_name = fn_pair.first;
         if (irc().IsIntrinsic(fn_name) || fn_name == "main") {
             continue;
         } 
@@ -9,7 +9,7 @@
 namespace papyrus {
 
 using T = Instruction::InstructionType;
-using VarMap = std::unordered_map<std::string, std::unordered_set<std::string> >;
+using SymbolMap = std::unordered_map<std::string, std::unordered_set<SymbolId> >;
 
 /*
  * GlobalClobbering Analysis tells us which functions "clobber" and "read" which 
@@ -23,13 +23,14 @@ class GlobalClobbering : public AnalysisPass {
 public:
     GlobalClobbering(IRConstructor&);
     void Run();
+    PreservedAnalyses Preserved() const { return PRESERVE_ALL; }
 
-    const VarMap& GetClobberStatus() const;
-    const VarMap& GetReadDefStatus() const;
+    const SymbolMap& GetClobberStatus() const;
+    const SymbolMap& GetReadDefStatus() const;
 
 private:
-    VarMap clobbered_vars_;
-    VarMap read_vars_;
+    SymbolMap clobbered_vars_;
+    SymbolMap read_vars_;
 
     std::unordered_set<std::string> visited_;
 
@@ -43,8 +44,8 @@ private:
      * but just to be safe.
      * UPDATE: Checked. Works.
      */
-    void Clobber(const std::string&, const std::string&);
-    void ReadDef(const std::string&, const std::string&);
+    void Clobber(const std::string&, SymbolId);
+    void ReadDef(const std::string&, SymbolId);
 };
 
 } // namespace papyrus
@@ -7,20 +7,24 @@ bool InterprocCallAnalysis::IsFunctionCall(T insty) const {
 }
 
 void InterprocCallAnalysis::Run() {
-    for (auto fn_pair: irc().Functions()) {
-        auto fn_name = fn_pair.first;
+    caller_info_.clear();
+    callee_info_.clear();
+
+    for (const auto& fn_pair: irc().Functions()) {
+        const auto& fn_name = fn_pair.first;
         if (irc().IsIntrinsic(fn_name)) {
             continue;
         } 
         auto fn = fn_pair.second;
 
-        caller_info_[fn_name] = {};
-        callee_info_[fn_name] = {};
+        // Callers may already have been recorded for fn_name
+        caller_info_[fn_name];
+        callee_info_[fn_name];
 
         for (auto bb_pair: fn->BasicBlocks()) {
             auto bb = bb_pair.second;
-            for (auto inst_pair: bb->Instructions()) {
-                auto inst = inst_pair.second;
+            for (auto ins_idx: bb->InstructionOrder()) {
+                auto inst = fn->GetInstruction(ins_idx);
 
                 // Collect all function call information
                 if (inst->IsActive() &&
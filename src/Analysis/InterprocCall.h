@@ -17,6 +17,7 @@ class InterprocCallAnalysis : public AnalysisPass {
 public:
     InterprocCallAnalysis(IRConstructor& irc) : AnalysisPass(irc) {}
     void Run();
+    PreservedAnalyses Preserved() const { return PRESERVE_ALL; }
 
     const VarMap& GetCallerInfo() const;
     const VarMap& GetCalleeInfo() const;
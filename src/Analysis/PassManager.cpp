@@ -0,0 +1,258 @@
+#include "PassManager.h"
+
+#include "ArrayLSRemover.h"
+#include "DCE.h"
+#include "GVN.h"
+#include "RedundantPhiRemover.h"
+
+#include "RegAlloc/IGBuilder.h"
+#include "RegAlloc/RegAlloc.h"
+
+#include "Papyrus/ThreadPool.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace papyrus;
+
+PassManager::PassManager(IRConstructor& irc) :
+    irc_(irc),
+    ra_(nullptr),
+    jobs_(1),
+    time_passes_(false) {}
+
+bool PassManager::IsKnownPass(const std::string& name) {
+    return (name == "phi" ||
+            name == "als" ||
+            name == "gvn" ||
+            name == "dce" ||
+            name == "regalloc");
+}
+
+void PassManager::Append(const std::string& name, std::unique_ptr<AnalysisPass> pass) {
+    // Function passes can run on several functions at once
+    FunctionPass* function_pass = dynamic_cast<FunctionPass*>(pass.get());
+    pipeline_.push_back({name, std::move(pass), function_pass});
+}
+
+void PassManager::AddPass(const std::string& name) {
+    if (name == "phi") {
+        Append(name, std::make_unique<RedundantPhiRemover>(irc_));
+    } else if (name == "als") {
+        Append(name, std::make_unique<ArrayLSRemover>(irc_));
+    } else if (name == "gvn") {
+        Append(name, std::make_unique<GVN>(irc_));
+    } else if (name == "dce") {
+        Append(name, std::make_unique<DCE>(irc_));
+    } else if (name == "regalloc") {
+        if (ra_ != nullptr) {
+            LOG(ERROR) << "[PASS] regalloc can only run once";
+            exit(1);
+        }
+
+        // The allocator colors the graph of the builder run right before it
+        auto igb = std::make_unique<IGBuilder>(irc_);
+        auto ra  = std::make_unique<RegAllocator>(irc_, *igb);
+        ra_ = ra.get();
+
+        Append("igbuilder", std::move(igb));
+        Append(name, std::move(ra));
+    } else {
+        LOG(ERROR) << "[PASS] Unknown pass " << name;
+        exit(1);
+    }
+}
+
+void PassManager::AddPipeline(int opt_level) {
+    switch (opt_level) {
+        case 0:
+            break;
+        case 1:
+            AddPass("als");
+            break;
+        case 2:
+            AddPass("phi");
+            AddPass("als");
+            AddPass("gvn");
+            break;
+        default:
+            LOG(ERROR) << "[PASS] Invalid optimization level " << opt_level;
+            exit(1);
+    }
+}
+
+std::size_t PassManager::FunctionSize(const Function* fn) {
+    std::size_t num_ins = 0;
+    for (const auto& bb_pair: fn->BasicBlocks()) {
+        num_ins += bb_pair.second->InstructionOrder().Size();
+    }
+
+    return num_ins;
+}
+
+std::size_t PassManager::IRSize() const {
+    std::size_t num_ins = 0;
+    for (const auto& fn_pair: irc_.Functions()) {
+        if (!irc_.IsIntrinsic(fn_pair.first)) {
+            num_ins += FunctionSize(fn_pair.second);
+        }
+    }
+
+    return num_ins;
+}
+
+void PassManager::RunPass(std::size_t pass_idx) {
+    auto start = Clock::now();
+    irc_.Analyses().RunPass(*pipeline_[pass_idx].pass);
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    if (time_passes_) {
+        seconds_[pass_idx] = elapsed.count();
+        sizes_[pass_idx]   = IRSize();
+    }
+}
+
+/*
+ * Runs the function passes [first, last) of the pipeline. Each function goes
+ * through all of them in one task, so that the functions are independent of
+ * each other until the stage is over.
+ */
+void PassManager::RunStage(std::size_t first, std::size_t last, ThreadPool& pool) {
+    std::vector<std::pair<std::size_t, Function*> > functions;
+    for (const auto& fn_pair: irc_.Functions()) {
+        if (!irc_.IsIntrinsic(fn_pair.first)) {
+            functions.push_back({FunctionSize(fn_pair.second), fn_pair.second});
+        }
+    }
+
+    // Largest functions first, so that no thread is left with a big one at
+    // the end while the others are idle
+    std::stable_sort(functions.begin(), functions.end(),
+                     [](const std::pair<std::size_t, Function*>& a,
+                        const std::pair<std::size_t, Function*>& b) {
+                         return a.first > b.first;
+                     });
+
+    std::size_t num_passes = last - first;
+
+    // Filled in by the tasks, [function][pass]
+    std::vector<double> seconds(functions.size() * num_passes, 0);
+    std::vector<std::size_t> sizes(functions.size() * num_passes, 0);
+
+    ValueTable& values = irc_.Values();
+    values.SetConcurrent(true);
+
+    for (std::size_t fn_idx = 0; fn_idx < functions.size(); fn_idx++) {
+        pool.Submit([this, &functions, &seconds, &sizes, fn_idx, first, last, num_passes] {
+            Function* fn = functions[fn_idx].second;
+
+            for (std::size_t pass_idx = first; pass_idx < last; pass_idx++) {
+                const auto& entry = pipeline_[pass_idx];
+
+                auto start = Clock::now();
+                entry.function_pass->RunOnFunction(fn);
+                fn->InvalidateAnalyses(entry.pass->Preserved());
+                std::chrono::duration<double> elapsed = Clock::now() - start;
+
+                std::size_t slot = fn_idx * num_passes + (pass_idx - first);
+                seconds[slot] = elapsed.count();
+                if (time_passes_) {
+                    sizes[slot] = FunctionSize(fn);
+                }
+            }
+        });
+    }
+    pool.Wait();
+
+    values.SetConcurrent(false);
+
+    PreservedAnalyses preserved = PRESERVE_ALL;
+    for (std::size_t pass_idx = first; pass_idx < last; pass_idx++) {
+        preserved &= pipeline_[pass_idx].pass->Preserved();
+    }
+    irc_.Analyses().InvalidateModule(preserved);
+
+    if (time_passes_) {
+        for (std::size_t fn_idx = 0; fn_idx < functions.size(); fn_idx++) {
+            for (std::size_t pass_idx = first; pass_idx < last; pass_idx++) {
+                std::size_t slot = fn_idx * num_passes + (pass_idx - first);
+                seconds_[pass_idx] += seconds[slot];
+                sizes_[pass_idx]   += sizes[slot];
+            }
+        }
+    }
+}
+
+void PassManager::Run() {
+    std::size_t initial_size = time_passes_ ? IRSize() : 0;
+    seconds_.assign(pipeline_.size(), 0);
+    sizes_.assign(pipeline_.size(), 0);
+
+    std::unique_ptr<ThreadPool> pool;
+    if (jobs_ != 1) {
+        pool = std::make_unique<ThreadPool>(jobs_);
+    }
+
+    auto start = Clock::now();
+
+    std::size_t pass_idx = 0;
+    while (pass_idx < pipeline_.size()) {
+        // Consecutive function passes make up a stage
+        std::size_t last = pass_idx;
+        while (pool != nullptr && last < pipeline_.size() &&
+               pipeline_[last].function_pass != nullptr) {
+            last++;
+        }
+
+        if (last == pass_idx) {
+            RunPass(pass_idx);
+            pass_idx++;
+        } else {
+            RunStage(pass_idx, last, *pool);
+            pass_idx = last;
+        }
+    }
+
+    std::chrono::duration<double> wall = Clock::now() - start;
+
+    if (time_passes_) {
+        ReportTimes(initial_size, wall.count());
+    }
+}
+
+void PassManager::ReportTimes(std::size_t initial_size, double wall) const {
+    double total = 0;
+    for (auto pass_seconds: seconds_) {
+        total += pass_seconds;
+    }
+
+    std::size_t width = 5;
+    for (const auto& entry: pipeline_) {
+        width = std::max(width, entry.name.size());
+    }
+
+    if (jobs_ != 1) {
+        LOG(INFO) << "[PASS] Times of function passes are summed over all threads";
+    }
+
+    std::ostringstream input;
+    input << std::left << std::setw(width) << "input"
+          << std::right << std::setw(29) << initial_size << " instructions";
+    LOG(INFO) << "[PASS] " << input.str();
+
+    for (std::size_t i = 0; i < pipeline_.size(); i++) {
+        std::ostringstream line;
+        line << std::left << std::setw(width) << pipeline_[i].name << std::right
+             << std::fixed << std::setprecision(6) << std::setw(11) << seconds_[i] << "s"
+             << std::setw(6) << std::setprecision(1)
+             << (total > 0 ? 100 * seconds_[i] / total : 0) << "%"
+             << std::setw(10) << sizes_[i] << " instructions";
+        LOG(INFO) << "[PASS] " << line.str();
+    }
+
+    std::ostringstream line;
+    line << std::left << std::setw(width) << "total" << std::right
+         << std::fixed << std::setprecision(6) << std::setw(11) << wall << "s";
+    LOG(INFO) << "[PASS] " << line.str();
+}
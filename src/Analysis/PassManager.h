@@ -0,0 +1,93 @@
+#ifndef PAPYRUS_PASS_MANAGER_H
+#define PAPYRUS_PASS_MANAGER_H
+
+#include "AnalysisManager.h"
+
+#include <chrono>
+#include <memory>
+
+namespace papyrus {
+
+class RegAllocator;
+class ThreadPool;
+
+/*
+ * PassManager runs a pipeline of passes over the IR, once it is constructed.
+ * The pipeline is either one of the -O presets or a list of pass names:
+ *
+ *   phi       RedundantPhiRemover, removes redundant groups of phis
+ *   als       ArrayLSRemover, removes redundant array loads and stores
+ *   gvn       global value numbering
+ *   dce       dead code elimination (under construction, never in a preset)
+ *   regalloc  builds the interference graph and colors it
+ *
+ *   -O0       no passes
+ *   -O1       als (the default)
+ *   -O2       phi, als, gvn
+ *
+ * Every pass is run through the AnalysisManager, so that the analyses it
+ * does not preserve are invalidated before the next one. With timing enabled,
+ * the wall time of every pass and the number of instructions left after it
+ * are reported.
+ *
+ * With more than one job, consecutive FunctionPasses make up a stage, and
+ * each function is sent through all the passes of the stage as one task on
+ * a ThreadPool. The functions are independent of each other, so the IR is
+ * the same as when the passes run one after the other.
+ */
+class PassManager {
+public:
+    PassManager(IRConstructor&);
+
+    static bool IsKnownPass(const std::string&);
+
+    // Appends a pass by name, or the passes of an optimization level
+    void AddPass(const std::string&);
+    void AddPipeline(int);
+
+    void SetTimePasses(bool time_passes) { time_passes_ = time_passes; }
+    // 0 picks one job per hardware thread
+    void SetJobs(unsigned jobs) { jobs_ = jobs; }
+
+    void Run();
+
+    // The register allocator of the pipeline, nullptr if there is none
+    const RegAllocator* GetRegAllocator() const { return ra_; }
+
+private:
+    IRConstructor& irc_;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct PipelineEntry {
+        std::string name;
+        std::unique_ptr<AnalysisPass> pass;
+        // Same as pass, nullptr unless it is a FunctionPass
+        FunctionPass* function_pass;
+    };
+    std::vector<PipelineEntry> pipeline_;
+
+    // Owned by pipeline_
+    RegAllocator* ra_;
+
+    unsigned jobs_;
+    bool time_passes_;
+
+    // Time spent in, and instructions left after, each pass of the pipeline
+    std::vector<double> seconds_;
+    std::vector<std::size_t> sizes_;
+
+    void Append(const std::string&, std::unique_ptr<AnalysisPass>);
+
+    void RunPass(std::size_t);
+    void RunStage(std::size_t, std::size_t, ThreadPool&);
+    void ReportTimes(std::size_t, double) const;
+
+    // Number of instructions in the BBs of the function, or of all of them
+    static std::size_t FunctionSize(const Function*);
+    std::size_t IRSize() const;
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_PASS_MANAGER_H */
@@ -0,0 +1,175 @@
+#include "RedundantPhiRemover.h"
+
+using namespace papyrus;
+
+/*
+ * Tarjan's algorithm over the phis, with an edge from a phi to each of its
+ * operands which is the result of another of the phis. Components come out
+ * once all the components they refer to have, so the operands of a phi are
+ * dealt with before the phi itself.
+ *
+ * The walk is kept on an explicit stack, since a chain of phis can be as long
+ * as a chain of loops.
+ */
+std::vector<std::vector<II> > RedundantPhiRemover::PhiSCCs(Function* fn,
+                                                           const std::vector<II>& phis,
+                                                           const PhiDefs& defs) {
+    std::vector<std::vector<II> > sccs;
+
+    // Position of each phi in phis, only the phis in there are looked at
+    std::unordered_map<II, std::size_t> node_of;
+    for (std::size_t node = 0; node < phis.size(); node++) {
+        node_of.emplace(phis[node], node);
+    }
+
+    const int NOT_VISITED = -1;
+    std::vector<int> index(phis.size(), NOT_VISITED);
+    std::vector<int> lowlink(phis.size(), 0);
+    std::vector<bool> on_stack(phis.size(), false);
+    std::vector<std::size_t> scc_stack;
+    int counter = 0;
+
+    // Phi, and the number of its operands followed so far
+    std::vector<std::pair<std::size_t, std::size_t> > worklist;
+
+    auto visit = [&](std::size_t node) {
+        index[node] = lowlink[node] = counter++;
+        scc_stack.push_back(node);
+        on_stack[node] = true;
+        worklist.push_back({node, 0});
+    };
+
+    for (std::size_t root = 0; root < phis.size(); root++) {
+        if (index[root] != NOT_VISITED) {
+            continue;
+        }
+
+        visit(root);
+        while (!worklist.empty()) {
+            auto node = worklist.back().first;
+            const auto& operands = fn->GetInstruction(phis[node])->Operands();
+
+            if (worklist.back().second < operands.size()) {
+                VI op = operands[worklist.back().second++];
+
+                auto phi_it = defs.find(op);
+                if (phi_it == defs.end()) {
+                    continue;
+                }
+                auto node_it = node_of.find(phi_it->second);
+                if (node_it == node_of.end()) {
+                    continue;
+                }
+
+                auto succ = node_it->second;
+                if (index[succ] == NOT_VISITED) {
+                    visit(succ);
+                } else if (on_stack[succ]) {
+                    lowlink[node] = std::min(lowlink[node], index[succ]);
+                }
+                continue;
+            }
+
+            worklist.pop_back();
+            if (!worklist.empty()) {
+                auto parent = worklist.back().first;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[node]);
+            }
+
+            if (lowlink[node] == index[node]) {
+                std::vector<II> scc;
+                std::size_t member;
+                do {
+                    member = scc_stack.back();
+                    scc_stack.pop_back();
+                    on_stack[member] = false;
+                    scc.push_back(phis[member]);
+                } while (member != node);
+
+                sccs.push_back(std::move(scc));
+            }
+        }
+    }
+
+    return sccs;
+}
+
+/*
+ * A component which refers to a single value from outside of it computes
+ * nothing but that value, and is replaced by it. Otherwise, the phis with
+ * all their operands inside the component may still form smaller redundant
+ * components, which are searched for in turn. The recursion is as deep as
+ * the loops are nested.
+ */
+std::size_t RedundantPhiRemover::RemoveRedundantPhis(Function* fn,
+                                                     const std::vector<II>& phis,
+                                                     const PhiDefs& defs) {
+    std::size_t removed = 0;
+
+    for (const auto& scc: PhiSCCs(fn, phis, defs)) {
+        std::unordered_set<VI> results;
+        for (auto phi_ins: scc) {
+            results.insert(fn->GetInstruction(phi_ins)->Result());
+        }
+
+        std::vector<VI> outer_ops;
+        std::vector<II> inner;
+        for (auto phi_ins: scc) {
+            bool is_inner = true;
+
+            for (auto op: fn->GetInstruction(phi_ins)->Operands()) {
+                if (results.find(op) != results.end()) {
+                    continue;
+                }
+
+                is_inner = false;
+                if (std::find(outer_ops.begin(), outer_ops.end(), op) == outer_ops.end()) {
+                    outer_ops.push_back(op);
+                }
+            }
+
+            if (is_inner) {
+                inner.push_back(phi_ins);
+            }
+        }
+
+        if (outer_ops.size() == 1) {
+            // Phi operands are on the use lists, so this reaches the phis
+            // outside the component using its results as well
+            for (auto phi_ins: scc) {
+                fn->ReplaceUse(fn->GetInstruction(phi_ins)->Result(), outer_ops[0]);
+                fn->RemoveInstruction(phi_ins);
+            }
+            removed += scc.size();
+        } else if (outer_ops.size() > 1 && !inner.empty()) {
+            removed += RemoveRedundantPhis(fn, inner, defs);
+        }
+    }
+
+    return removed;
+}
+
+void RedundantPhiRemover::RunOnFunction(Function* fn) {
+    std::vector<II> phis;
+    PhiDefs defs;
+
+    for (auto bb_idx: fn->ReversePostOrderCFG()) {
+        for (auto ins_idx: fn->GetBB(bb_idx)->InstructionOrder()) {
+            auto ins = fn->GetInstruction(ins_idx);
+            // Phis may come after the kills at the top of the BB
+            if (!ins->IsPhi()) {
+                continue;
+            }
+
+            if (defs.emplace(ins->Result(), ins_idx).second) {
+                phis.push_back(ins_idx);
+            }
+        }
+    }
+
+    std::size_t removed = RemoveRedundantPhis(fn, phis, defs);
+
+    LOG(INFO) << "[PHI] Removed " << removed << " phis from " << fn->FunctionName();
+
+    num_removed_ += removed;
+}
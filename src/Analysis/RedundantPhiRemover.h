@@ -0,0 +1,47 @@
+#ifndef PAPYRUS_REDUNDANT_PHI_REMOVER_H
+#define PAPYRUS_REDUNDANT_PHI_REMOVER_H
+
+#include "AnalysisPass.h"
+
+#include <atomic>
+
+namespace papyrus {
+
+/*
+ * RedundantPhiRemover makes the SSA form minimal once it is constructed, as
+ * described in section 3.2 of "Simple and Efficient Construction of Static
+ * Single Assignment Form" by Braun et. al.
+ *
+ * During construction, a phi is only removed if it is trivial on its own.
+ * Loops leave behind groups of phis which only refer to each other and to a
+ * single value from outside the group, such as a variable which is left
+ * alone by the loop body. The phis are grouped into strongly connected
+ * components with Tarjan's algorithm, following operands, and a component
+ * with a single outside operand is replaced by that operand. If there are
+ * more, the phis of the component whose operands all lie inside of it are
+ * searched again for smaller redundant components.
+ */
+class RedundantPhiRemover : public FunctionPass {
+public:
+    RedundantPhiRemover(IRConstructor& irc) : FunctionPass(irc), num_removed_(0) {}
+    void RunOnFunction(Function*);
+
+    // Only phis are removed
+    PreservedAnalyses Preserved() const { return PRESERVE_CFG | ANALYSIS_CALL_GRAPH; }
+
+    // Number of phis removed so far, from all functions
+    std::size_t NumRemoved() const { return num_removed_; }
+
+private:
+    std::atomic<std::size_t> num_removed_;
+
+    // The phi defining each phi result of the function being processed
+    using PhiDefs = std::unordered_map<VI, II>;
+
+    std::size_t RemoveRedundantPhis(Function*, const std::vector<II>&, const PhiDefs&);
+    std::vector<std::vector<II> > PhiSCCs(Function*, const std::vector<II>&, const PhiDefs&);
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_REDUNDANT_PHI_REMOVER_H */
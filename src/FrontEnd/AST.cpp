@@ -2,165 +2,211 @@
 
 using namespace papyrus;
 
-////////////////////////////////////
-// IdentifierNode
-////////////////////////////////////
-IdentifierNode::IdentifierNode(const std::string& identifier_name) :
-    identifier_name_(identifier_name) {}
-
-////////////////////////////////////
-// ConstantNode
-////////////////////////////////////
-ConstantNode::ConstantNode(int value) :
-    value_(value) {}
-
 ////////////////////////////////////
 // FactorNode
 ////////////////////////////////////
-FactorNode::FactorNode(DesignatorNode* desig) :
-    factor_node_(static_cast<ValueNode*>(desig)),
-    factor_type_(FactorType::FACT_DESIGNATOR) {}
-
-FactorNode::FactorNode(ConstantNode* constant) :
-    factor_node_(static_cast<ValueNode*>(constant)),
-    factor_type_(FactorType::FACT_NUMBER) {}
+FactorNode::FactorNode(NodeRef<DesignatorNode> desig) :
+    factor_type_(FactorType::FACT_DESIGNATOR),
+    index_(desig.Index()) {}
 
-FactorNode::FactorNode(ExpressionNode* expr) :
-    factor_node_(static_cast<ValueNode*>(expr)),
-    factor_type_(FactorType::FACT_EXPR) {}
+FactorNode::FactorNode(int value) :
+    factor_type_(FactorType::FACT_NUMBER),
+    value_(value) {}
 
-FactorNode::FactorNode(FunctionCallNode* func_call) :
-    factor_node_(static_cast<ValueNode*>(func_call)),
-    factor_type_(FactorType::FACT_FUNCCALL) {}
+FactorNode::FactorNode(NodeRef<ExpressionNode> expr) :
+    factor_type_(FactorType::FACT_EXPR),
+    index_(expr.Index()) {}
+
+FactorNode::FactorNode(NodeRef<FunctionCallNode> func_call) :
+    factor_type_(FactorType::FACT_FUNCCALL),
+    index_(func_call.Index()) {}
+
+FactorNode FactorNode::Rebased(const PoolOffsets& offsets) const {
+    FactorNode rebased = *this;
+    switch(factor_type_) {
+        case FACT_DESIGNATOR:
+            rebased.index_ += offsets.designators;
+            break;
+        case FACT_EXPR:
+            rebased.index_ += offsets.expressions;
+            break;
+        case FACT_FUNCCALL:
+            rebased.index_ += offsets.calls;
+            break;
+        case FACT_NUMBER:
+            break;
+    }
+
+    return rebased;
+}
 
 ////////////////////////////////////
 // TermNode
 ////////////////////////////////////
-TermNode::TermNode(FactorNode* factor) :
-    primary_factor_(factor) {}
+TermNode::TermNode(NodeRef<FactorNode> factor, ListRange secondary_factors) :
+    primary_factor_(factor),
+    secondary_factors_(secondary_factors) {}
 
-void TermNode::AddSecondaryFactor(ArithmeticOperator op, FactorNode* factor) {
-    secondary_factors_.push_back({op, factor});
+TermNode TermNode::Rebased(const PoolOffsets& offsets) const {
+    return TermNode(Shift(primary_factor_, offsets.factors),
+                    Shift(secondary_factors_, offsets.factor_lists));
 }
 
 ////////////////////////////////////
 // ExpressionNode
 ////////////////////////////////////
-ExpressionNode::ExpressionNode(TermNode* term) :
-    primary_term_(term) {}
+ExpressionNode::ExpressionNode(NodeRef<TermNode> term, ListRange secondary_terms) :
+    primary_term_(term),
+    secondary_terms_(secondary_terms) {}
 
-void ExpressionNode::AddSecondaryTerm(ArithmeticOperator op, TermNode* term) {
-    secondary_terms_.push_back({op, term});
+ExpressionNode ExpressionNode::Rebased(const PoolOffsets& offsets) const {
+    return ExpressionNode(Shift(primary_term_, offsets.terms),
+                          Shift(secondary_terms_, offsets.term_lists));
 }
 
 ////////////////////////////////////
 // DesignatorNode
 ////////////////////////////////////
-DesignatorNode::DesignatorNode(IdentifierNode* identifier) :
-    identifier_(identifier) {}
+DesignatorNode::DesignatorNode(SymbolId identifier) :
+    identifier_(identifier),
+    desig_type_(DESIG_VAR) {}
 
-////////////////////////////////////
-// VarIdentifierNode
-////////////////////////////////////
-VarIdentifierNode::VarIdentifierNode(IdentifierNode* identifier) :
-    DesignatorNode(identifier) {
-    desig_type_ = DESIG_VAR;
-}
+DesignatorNode::DesignatorNode(SymbolId identifier, ListRange indirections) :
+    identifier_(identifier),
+    desig_type_(DESIG_ARR),
+    indirections_(indirections) {}
 
-////////////////////////////////////
-// ArrayIdentifierNode
-////////////////////////////////////
-ArrIdentifierNode::ArrIdentifierNode(IdentifierNode* identifier) :
-    DesignatorNode(identifier) {
-    desig_type_ = DESIG_ARR;
-}
+DesignatorNode DesignatorNode::Rebased(const PoolOffsets& offsets) const {
+    DesignatorNode rebased = *this;
+    rebased.indirections_ = Shift(indirections_, offsets.expression_lists);
 
-void ArrIdentifierNode::AddIndirectionToArray(ExpressionNode* indirection) {
-    indirections_.push_back(indirection);
+    return rebased;
 }
 
 ////////////////////////////////////
 // StatementNode
 ////////////////////////////////////
+StatementNode::StatementNode(StatementType statement_type, uint32_t index) :
+    statement_type_(statement_type),
+    index_(index) {}
+
+StatementNode StatementNode::Rebased(const PoolOffsets& offsets) const {
+    uint32_t offset = 0;
+    switch(statement_type_) {
+        case STAT_FUNCCALL:
+            offset = offsets.calls;
+            break;
+        case STAT_ASSIGN:
+            offset = offsets.assignments;
+            break;
+        case STAT_ITE:
+            offset = offsets.ites;
+            break;
+        case STAT_RETURN:
+            offset = offsets.returns;
+            break;
+        case STAT_WHILE:
+            offset = offsets.whiles;
+            break;
+        default:
+            break;
+    }
+
+    return StatementNode(statement_type_, index_ + offset);
+}
 
 //////////////////////////////////////
 // FunctionCallNode
 ////////////////////////////////////
-FunctionCallNode::FunctionCallNode(IdentifierNode* identifier) :
+FunctionCallNode::FunctionCallNode(SymbolId identifier, ListRange arguments) :
     identifier_(identifier),
-    StatementNode() {
-        statement_type_ = StatementType::STAT_FUNCCALL;
-}
+    arguments_(arguments) {}
 
-void FunctionCallNode::AddArgument(ExpressionNode* expression) {
-    arguments_.push_back(expression);
+FunctionCallNode FunctionCallNode::Rebased(const PoolOffsets& offsets) const {
+    return FunctionCallNode(identifier_, Shift(arguments_, offsets.expression_lists));
 }
 
 //////////////////////////////////////
 // AssignmentNode
 ////////////////////////////////////
-AssignmentNode::AssignmentNode(DesignatorNode* designator, ExpressionNode* value) :
+AssignmentNode::AssignmentNode(NodeRef<DesignatorNode> designator, NodeRef<ExpressionNode> value) :
     designator_(designator),
-    value_(value),
-    StatementNode() {
-        statement_type_ = StatementType::STAT_ASSIGN;
+    value_(value) {}
+
+AssignmentNode AssignmentNode::Rebased(const PoolOffsets& offsets) const {
+    return AssignmentNode(Shift(designator_, offsets.designators),
+                          Shift(value_, offsets.expressions));
 }
 
 ////////////////////////////////////
 // ITENode
 ////////////////////////////////////
-ITENode::ITENode(RelationNode* relation, StatSequenceNode* then_sequence) :
+ITENode::ITENode(NodeRef<RelationNode> relation,
+                 NodeRef<StatSequenceNode> then_sequence,
+                 NodeRef<StatSequenceNode> else_sequence) :
     relation_(relation),
     then_sequence_(then_sequence),
-    StatementNode() {
-        statement_type_ = STAT_ITE;
-}
+    else_sequence_(else_sequence) {}
 
-void ITENode::AddElseClause(StatSequenceNode* else_sequence) {
-    else_sequence_ = else_sequence;
+ITENode ITENode::Rebased(const PoolOffsets& offsets) const {
+    return ITENode(Shift(relation_, offsets.relations),
+                   Shift(then_sequence_, offsets.sequences),
+                   Shift(else_sequence_, offsets.sequences));
 }
 
 ////////////////////////////////////
 // ReturnNode
 ////////////////////////////////////
-ReturnNode::ReturnNode() :
-    StatementNode() {
-        statement_type_ = STAT_RETURN;
-}
+ReturnNode::ReturnNode(NodeRef<ExpressionNode> return_expression) :
+    return_expression_(return_expression) {}
 
-void ReturnNode::AddReturnExpression(ExpressionNode* return_expression) {
-    return_expression_ = return_expression;
+ReturnNode ReturnNode::Rebased(const PoolOffsets& offsets) const {
+    return ReturnNode(Shift(return_expression_, offsets.expressions));
 }
 
 ////////////////////////////////////
 // WhileNode
 ////////////////////////////////////
-WhileNode::WhileNode(RelationNode* loop_condition, StatSequenceNode* statement_sequence) :
+WhileNode::WhileNode(NodeRef<RelationNode> loop_condition, NodeRef<StatSequenceNode> statement_sequence) :
     loop_condition_(loop_condition),
-    statement_sequence_(statement_sequence),
-    StatementNode() {
-        statement_type_ = STAT_WHILE;
+    statement_sequence_(statement_sequence) {}
+
+WhileNode WhileNode::Rebased(const PoolOffsets& offsets) const {
+    return WhileNode(Shift(loop_condition_, offsets.relations),
+                     Shift(statement_sequence_, offsets.sequences));
 }
 
 ////////////////////////////////////
 // StatSequenceNode
 ////////////////////////////////////
-void StatSequenceNode::AddStatementToSequence(StatementNode* statement) {
-    statements_.push_back(statement);
+StatSequenceNode::StatSequenceNode(ListRange statements) :
+    statements_(statements) {}
+
+StatSequenceNode StatSequenceNode::Rebased(const PoolOffsets& offsets) const {
+    return StatSequenceNode(Shift(statements_, offsets.statement_lists));
 }
 
 ////////////////////////////////////
 // RelationNode
 ////////////////////////////////////
-RelationNode::RelationNode(ExpressionNode* left_expr, RelationalOperator op, ExpressionNode* right_expr) :
+RelationNode::RelationNode(NodeRef<ExpressionNode> left_expr, RelationalOperator op, NodeRef<ExpressionNode> right_expr) :
     left_expr_(left_expr),
     op_(op),
     right_expr_(right_expr) {}
 
+RelationNode RelationNode::Rebased(const PoolOffsets& offsets) const {
+    return RelationNode(Shift(left_expr_, offsets.expressions),
+                        op_,
+                        Shift(right_expr_, offsets.expressions));
+}
+
 ////////////////////////////////////
 // TypeDeclNode
 ////////////////////////////////////
-void TypeDeclNode::AddArrayDimension(ConstantNode* dimension) {
+TypeDeclNode::TypeDeclNode() :
+    is_array_(false) {}
+
+void TypeDeclNode::AddArrayDimension(int dimension) {
     dimensions_.push_back(dimension);
 }
 
@@ -168,27 +214,118 @@ void TypeDeclNode::SetIfArray(bool is_it_array) {
     is_array_ = is_it_array;
 }
 
-////////////////////////////////////
-// FunctionBodyNode
-////////////////////////////////////
-void FunctionBodyNode::SetFunctionBodyStatSequence(StatSequenceNode* stat) {
-    func_statement_sequence_ = stat;
-}
-
 ////////////////////////////////////
 // FunctionDeclNode
 ////////////////////////////////////
-FunctionDeclNode::FunctionDeclNode(IdentifierNode* identifier, FunctionBodyNode* func_body) :
+FunctionDeclNode::FunctionDeclNode(SymbolId identifier, NodeRef<StatSequenceNode> func_body) :
     identifier_(identifier),
     func_body_(func_body) {}
 
+FunctionDeclNode FunctionDeclNode::Rebased(const PoolOffsets& offsets) const {
+    return FunctionDeclNode(identifier_, Shift(func_body_, offsets.sequences));
+}
+
 ////////////////////////////////////
 // ComputationNode
 ////////////////////////////////////
-void ComputationNode::AddFunctionDecl(FunctionDeclNode* func_declaration) {
-    function_declarations_.push_back(func_declaration);
-}
+ComputationNode::ComputationNode() {}
 
-void ComputationNode::SetComputationBody(StatSequenceNode* computation_body) {
+void ComputationNode::SetComputationBody(NodeRef<StatSequenceNode> computation_body) {
     computation_body_ = computation_body;
 }
+
+////////////////////////////////////
+// ASTPool
+////////////////////////////////////
+std::size_t ASTPool::BytesAllocated() const {
+    return factors.BytesAllocated() +
+           terms.BytesAllocated() +
+           expressions.BytesAllocated() +
+           designators.BytesAllocated() +
+           relations.BytesAllocated() +
+           calls.BytesAllocated() +
+           assignments.BytesAllocated() +
+           ites.BytesAllocated() +
+           whiles.BytesAllocated() +
+           returns.BytesAllocated() +
+           sequences.BytesAllocated() +
+           functions.BytesAllocated() +
+           factor_lists.BytesAllocated() +
+           term_lists.BytesAllocated() +
+           expression_lists.BytesAllocated() +
+           statement_lists.BytesAllocated();
+}
+
+void ASTPool::Clear() {
+    factors.Clear();
+    terms.Clear();
+    expressions.Clear();
+    designators.Clear();
+    relations.Clear();
+    calls.Clear();
+    assignments.Clear();
+    ites.Clear();
+    whiles.Clear();
+    returns.Clear();
+    sequences.Clear();
+    functions.Clear();
+
+    factor_lists.Clear();
+    term_lists.Clear();
+    expression_lists.Clear();
+    statement_lists.Clear();
+}
+
+PoolOffsets ASTPool::Sizes() const {
+    PoolOffsets sizes;
+
+    sizes.factors     = factors.Size();
+    sizes.terms       = terms.Size();
+    sizes.expressions = expressions.Size();
+    sizes.designators = designators.Size();
+    sizes.relations   = relations.Size();
+    sizes.calls       = calls.Size();
+    sizes.assignments = assignments.Size();
+    sizes.ites        = ites.Size();
+    sizes.whiles      = whiles.Size();
+    sizes.returns     = returns.Size();
+    sizes.sequences   = sequences.Size();
+    sizes.functions   = functions.Size();
+
+    sizes.factor_lists     = factor_lists.Size();
+    sizes.term_lists       = term_lists.Size();
+    sizes.expression_lists = expression_lists.Size();
+    sizes.statement_lists  = statement_lists.Size();
+
+    return sizes;
+}
+
+void ASTPool::Append(const ASTPool& other) {
+    const PoolOffsets offsets = Sizes();
+
+    auto rebase_node = [&offsets](const auto& node) { return node.Rebased(offsets); };
+
+    factors.Append(other.factors, rebase_node);
+    terms.Append(other.terms, rebase_node);
+    expressions.Append(other.expressions, rebase_node);
+    designators.Append(other.designators, rebase_node);
+    relations.Append(other.relations, rebase_node);
+    calls.Append(other.calls, rebase_node);
+    assignments.Append(other.assignments, rebase_node);
+    ites.Append(other.ites, rebase_node);
+    whiles.Append(other.whiles, rebase_node);
+    returns.Append(other.returns, rebase_node);
+    sequences.Append(other.sequences, rebase_node);
+    functions.Append(other.functions, rebase_node);
+
+    factor_lists.Append(other.factor_lists, [&offsets](const std::pair<ArithmeticOperator, NodeRef<FactorNode> >& elem) {
+        return std::make_pair(elem.first, Shift(elem.second, offsets.factors));
+    });
+    term_lists.Append(other.term_lists, [&offsets](const std::pair<ArithmeticOperator, NodeRef<TermNode> >& elem) {
+        return std::make_pair(elem.first, Shift(elem.second, offsets.terms));
+    });
+    expression_lists.Append(other.expression_lists, [&offsets](NodeRef<ExpressionNode> elem) {
+        return Shift(elem, offsets.expressions);
+    });
+    statement_lists.Append(other.statement_lists, rebase_node);
+}
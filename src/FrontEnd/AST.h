@@ -3,9 +3,12 @@
 
 #include "Papyrus/Logger/Logger.h"
 #include "Operation.h"
+#include "Interner.h"
+#include "NodePool.h"
 
 #include <string>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #define NOTFOUND -1
@@ -26,50 +29,25 @@ using IRC = IRConstructor;
  * it is created. This leads to more bookkeeping when walking/visiting over
  * each node during IR construction.
  *
- * Looking back at it, I would make implicit certain nodes so as to remove 
+ * Looking back at it, I would make implicit certain nodes so as to remove
  * extra computation
+ *
+ * Nodes are small values stored in the typed pools of an ASTPool (one per
+ * ASTConstructor). Children are referred to by NodeRef and lists of children
+ * by ListRange, both of which are resolved through the ASTPool. Identifiers,
+ * numbers and statements are stored inline in their parent.
  */
 
-////////////////////////////////
-class ASTNode {};
-////////////////////////////////
-
-////////////////////////////////
-class ValueNode : public ASTNode {};
-////////////////////////////////
-
-////////////////////////////////
-class IdentifierNode : public ASTNode {
-public:
-    IdentifierNode(const std::string&);
-    const std::string& IdentifierName() const { return identifier_name_; }
-
-protected:
-    std::string identifier_name_;
-};
-////////////////////////////////
-
-////////////////////////////////
-class ConstantNode : public ValueNode {
-public:
-    ConstantNode(int);
-    const int GetConstantValue() const { return value_; }
-
-    ValueIndex GenerateIR(IRC& irc) const;
-
-protected:
-    int value_;
-};
-////////////////////////////////
-
 ////////////////////////////////
 class DesignatorNode;
 class ExpressionNode;
 class FunctionCallNode;
+class StatSequenceNode;
+struct PoolOffsets;
 ////////////////////////////////
 
 ////////////////////////////////
-class FactorNode : public ASTNode {
+class FactorNode {
 public:
     enum FactorType {
         FACT_DESIGNATOR = 0,
@@ -78,44 +56,52 @@ public:
         FACT_FUNCCALL = 3,
     };
 
-    FactorNode(DesignatorNode*);
-    FactorNode(ConstantNode*);
-    FactorNode(ExpressionNode*);
-    FactorNode(FunctionCallNode*);
+    FactorNode(NodeRef<DesignatorNode>);
+    FactorNode(int);
+    FactorNode(NodeRef<ExpressionNode>);
+    FactorNode(NodeRef<FunctionCallNode>);
 
     ValueIndex GenerateIR(IRC&) const;
+    FactorNode Rebased(const PoolOffsets&) const;
 
 private:
-    ValueNode* factor_node_;
     FactorType factor_type_;
+    union {
+        // Node in the pool for factor_type_
+        uint32_t index_;
+        // FACT_NUMBER
+        int value_;
+    };
 };
 ////////////////////////////////
 
 ////////////////////////////////
-class TermNode : public ASTNode {
+class TermNode {
 public:
-    TermNode(FactorNode*);
-    void AddSecondaryFactor(ArithmeticOperator, FactorNode*);
+    TermNode(NodeRef<FactorNode>, ListRange);
 
     ValueIndex GenerateIR(IRC&) const;
+    TermNode Rebased(const PoolOffsets&) const;
 
 private:
-    FactorNode* primary_factor_;
-    std::vector<std::pair<ArithmeticOperator, FactorNode*> > secondary_factors_;
+    NodeRef<FactorNode> primary_factor_;
+    // (op, factor) pairs
+    ListRange secondary_factors_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-class ExpressionNode : public ValueNode {
+class ExpressionNode {
 public:
-    ExpressionNode(TermNode*);
-    void AddSecondaryTerm(ArithmeticOperator, TermNode*);
+    ExpressionNode(NodeRef<TermNode>, ListRange);
 
     ValueIndex GenerateIR(IRC&) const;
+    ExpressionNode Rebased(const PoolOffsets&) const;
 
 private:
-    TermNode* primary_term_;
-    std::vector<std::pair<ArithmeticOperator, TermNode*> > secondary_terms_;
+    NodeRef<TermNode> primary_term_;
+    // (op, term) pairs
+    ListRange secondary_terms_;
 };
 ////////////////////////////////
 
@@ -127,67 +113,43 @@ enum DesignatorType {
     DESIG_ANY
 };
 
-class DesignatorNode : public ValueNode {
-public:
-    const std::string& IdentifierName() const { return identifier_->IdentifierName(); }
-    DesignatorType GetDesignatorType() const { return desig_type_; }
-
-    ValueIndex GenerateIR(IRC&) const;
-
-protected:
-
-    IdentifierNode* identifier_;
-    DesignatorNode(IdentifierNode*);
-    DesignatorType desig_type_;
-};
-////////////////////////////////
-
-////////////////////////////////
-// The DesignatorNode is used a parent class for two nodes:
-// VarIdentifierNode for (scalar) variables
-// ArrIdentifierNode for arrays
-////////////////////////////////
-class VarIdentifierNode : public DesignatorNode {
+// A designator is either a (scalar) variable or an array element
+class DesignatorNode {
 public:
-    VarIdentifierNode(IdentifierNode*);
-
-    ValueIndex GenerateIR(IRC&) const;
-};
-////////////////////////////////
+    DesignatorNode(SymbolId);
+    DesignatorNode(SymbolId, ListRange);
 
-////////////////////////////////
-class ArrIdentifierNode : public DesignatorNode {
-public:
-    ArrIdentifierNode(IdentifierNode*);
-    void AddIndirectionToArray(ExpressionNode*);
+    const std::string& IdentifierName() const { return SymbolName(identifier_); }
+    SymbolId GetSymbol() const { return identifier_; }
+    DesignatorType GetDesignatorType() const { return desig_type_; }
 
     ValueIndex GenerateIR(IRC&) const;
+    // Address of the array element, DESIG_ARR only
+    ValueIndex GenerateAddressIR(IRC&) const;
+    DesignatorNode Rebased(const PoolOffsets&) const;
 
 private:
-    std::vector<ExpressionNode*> indirections_;
+    SymbolId identifier_;
+    DesignatorType desig_type_;
+    // Expressions indexing into the array
+    ListRange indirections_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-class RelationNode : public ASTNode {
+class RelationNode {
 public:
-    RelationNode(ExpressionNode*, RelationalOperator, ExpressionNode*);
+    RelationNode(NodeRef<ExpressionNode>, RelationalOperator, NodeRef<ExpressionNode>);
 
     RelationalOperator GetOp() const { return op_; }
 
-    bool IsReducible(ValueIndex, ValueIndex) const;
-
     ValueIndex GenerateIR(IRC&) const;
-    ValueIndex Left() const { return left_idx_; }
-    ValueIndex Right() const { return right_idx_; }
+    RelationNode Rebased(const PoolOffsets&) const;
 
 private:
-    ExpressionNode* left_expr_;
+    NodeRef<ExpressionNode> left_expr_;
     RelationalOperator op_;
-    ExpressionNode* right_expr_;
-
-    ValueIndex left_idx_;
-    ValueIndex right_idx_;
+    NodeRef<ExpressionNode> right_expr_;
 };
 ////////////////////////////////
 
@@ -204,169 +166,217 @@ enum StatementType {
     STAT_ANY,
 };
 
-class StatementNode : public ASTNode {
+// A statement in the program can be either of those described by the
+// StatementType enum. The StatementNode refers to the node in the pool for
+// its type.
+class StatementNode {
 public:
+    StatementNode(StatementType, uint32_t);
+
     const StatementType GetStatementType() const { return statement_type_; }
 
     ValueIndex GenerateIR(IRC&) const;
+    StatementNode Rebased(const PoolOffsets&) const;
 
-protected:
+private:
     StatementType statement_type_;
+    uint32_t index_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-// The StatementNode is used as a parent node for multiple
-// child nodes. A statement in the program can be either of those
-// described by the StatementType enum.
-class FunctionCallNode : public ValueNode, public StatementNode {
+class FunctionCallNode {
 public:
-    FunctionCallNode(IdentifierNode*);
-    void AddArgument(ExpressionNode*);
+    FunctionCallNode(SymbolId, ListRange);
 
     ValueIndex GenerateIR(IRC&) const;
+    FunctionCallNode Rebased(const PoolOffsets&) const;
 
 private:
-    IdentifierNode* identifier_;
-    std::vector<ExpressionNode*> arguments_;
+    SymbolId identifier_;
+    // Argument expressions
+    ListRange arguments_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-class AssignmentNode : public StatementNode {
+class AssignmentNode {
 public:
-    AssignmentNode(DesignatorNode*, ExpressionNode*);
-
-    const ExpressionNode* GetAssignedExpression() const { return value_; }
-    const DesignatorNode* GetDesignator() const { return designator_; }
+    AssignmentNode(NodeRef<DesignatorNode>, NodeRef<ExpressionNode>);
 
     ValueIndex GenerateIR(IRC&) const;
+    AssignmentNode Rebased(const PoolOffsets&) const;
 
 private:
-    DesignatorNode* designator_;
-    ExpressionNode* value_;
+    NodeRef<DesignatorNode> designator_;
+    NodeRef<ExpressionNode> value_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-class StatSequenceNode : public ASTNode {
+class StatSequenceNode {
 public:
-    void AddStatementToSequence(StatementNode*);
-    std::vector<StatementNode*>::const_iterator GetStatementBegin() const { return statements_.cbegin(); }
-    std::vector<StatementNode*>::const_iterator GetStatementEnd() const { return statements_.cend(); }
+    StatSequenceNode(ListRange);
 
     void GenerateIR(IRC&) const;
+    StatSequenceNode Rebased(const PoolOffsets&) const;
 
 private:
-    std::vector<StatementNode*> statements_;
+    ListRange statements_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-class ITENode : public StatementNode {
+class ITENode {
 public:
-    ITENode(RelationNode*, StatSequenceNode*);
-    void AddElseClause(StatSequenceNode*);
+    // The else sequence is not valid if there is no else clause
+    ITENode(NodeRef<RelationNode>, NodeRef<StatSequenceNode>, NodeRef<StatSequenceNode>);
 
     ValueIndex GenerateIR(IRC&) const;
-    ValueIndex TryReducingCmp(IRC&, ValueIndex, ValueIndex) const;
+    ValueIndex TryReducingCmp(IRC&) const;
+    ITENode Rebased(const PoolOffsets&) const;
 
 private:
-    RelationNode* relation_;
-    // Memory leak fix
-    StatSequenceNode* then_sequence_ = nullptr;
-    StatSequenceNode* else_sequence_ = nullptr;
+    NodeRef<RelationNode> relation_;
+    NodeRef<StatSequenceNode> then_sequence_;
+    NodeRef<StatSequenceNode> else_sequence_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-class ReturnNode : public StatementNode {
+class ReturnNode {
 public:
-    ReturnNode();
-    void AddReturnExpression(ExpressionNode*);
+    // The expression is not valid for a return without a value
+    ReturnNode(NodeRef<ExpressionNode>);
 
     ValueIndex GenerateIR(IRC&) const;
+    ReturnNode Rebased(const PoolOffsets&) const;
 
 private:
-    ExpressionNode* return_expression_;
+    NodeRef<ExpressionNode> return_expression_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-class WhileNode : public StatementNode {
+class WhileNode {
 public:
-    WhileNode(RelationNode*, StatSequenceNode*);
+    WhileNode(NodeRef<RelationNode>, NodeRef<StatSequenceNode>);
 
     ValueIndex GenerateIR(IRC&) const;
-    ValueIndex HandleReducibleCmp(IRC&, ValueIndex, ValueIndex) const;
+    WhileNode Rebased(const PoolOffsets&) const;
 
 private:
-    RelationNode* loop_condition_;
-    StatSequenceNode* statement_sequence_;
+    NodeRef<RelationNode> loop_condition_;
+    NodeRef<StatSequenceNode> statement_sequence_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-class TypeDeclNode : public ASTNode {
+// Not a part of the tree; the declared symbols are added to the symbol
+// table as they are parsed.
+class TypeDeclNode {
 public:
-    void AddArrayDimension(ConstantNode*);
-    std::vector<int> GetDimensions() const {
-        std::vector<int> dim;
-        for (auto constant: dimensions_) {
-            dim.push_back(constant->GetConstantValue());
-        }
-        return dim;
-    }
+    TypeDeclNode();
+    void AddArrayDimension(int);
+    const std::vector<int>& GetDimensions() const { return dimensions_; }
 
     const bool IsArray() const { return is_array_; }
     void SetIfArray(bool);
 
 private:
     bool is_array_;
-    std::vector<ConstantNode*> dimensions_;
+    std::vector<int> dimensions_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-class FunctionBodyNode : public ASTNode {
+class FunctionDeclNode {
 public:
-    void SetFunctionBodyStatSequence(StatSequenceNode*);
+    FunctionDeclNode(SymbolId, NodeRef<StatSequenceNode>);
+
+    const std::string& GetFunctionName() const { return SymbolName(identifier_); }
 
     void GenerateIR(IRC&) const;
+    FunctionDeclNode Rebased(const PoolOffsets&) const;
 
 private:
-    StatSequenceNode* func_statement_sequence_;
+    SymbolId identifier_;
+    NodeRef<StatSequenceNode> func_body_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-class FunctionDeclNode : public ASTNode {
+// ROOT node for the AST. The function declarations are the nodes in the
+// function pool, in order.
+////////////////////////////////
+class ComputationNode {
 public:
-    FunctionDeclNode(IdentifierNode*, FunctionBodyNode*);
-
-    const std::string& GetFunctionName() const { return identifier_->IdentifierName(); }
+    ComputationNode();
+    void SetComputationBody(NodeRef<StatSequenceNode>);
 
     void GenerateIR(IRC&) const;
 
 private:
-    IdentifierNode* identifier_;
-    FunctionBodyNode* func_body_;
+    NodeRef<StatSequenceNode> computation_body_;
 };
 ////////////////////////////////
 
 ////////////////////////////////
-// ROOT node for the AST
+// Sizes of the pools of an ASTPool. When another ASTPool is appended to it,
+// the nodes of the other pool are copied with Rebased(), which moves the
+// NodeRefs and ListRanges inside them past the nodes already present.
+////////////////////////////////
+struct PoolOffsets {
+    uint32_t factors;
+    uint32_t terms;
+    uint32_t expressions;
+    uint32_t designators;
+    uint32_t relations;
+    uint32_t calls;
+    uint32_t assignments;
+    uint32_t ites;
+    uint32_t whiles;
+    uint32_t returns;
+    uint32_t sequences;
+    uint32_t functions;
+
+    uint32_t factor_lists;
+    uint32_t term_lists;
+    uint32_t expression_lists;
+    uint32_t statement_lists;
+};
 ////////////////////////////////
-class ComputationNode : public ASTNode {
-public:
-    void AddFunctionDecl(FunctionDeclNode*);
-    void SetComputationBody(StatSequenceNode*);
 
-    void GenerateIR(IRC&) const;
-    
-private:
-    std::vector<FunctionDeclNode*> function_declarations_;
-    StatSequenceNode* computation_body_;
+////////////////////////////////
+// The pools holding every node of an AST
+////////////////////////////////
+class ASTPool {
+public:
+    NodePool<FactorNode> factors;
+    NodePool<TermNode> terms;
+    NodePool<ExpressionNode> expressions;
+    NodePool<DesignatorNode> designators;
+    NodePool<RelationNode> relations;
+    NodePool<FunctionCallNode> calls;
+    NodePool<AssignmentNode> assignments;
+    NodePool<ITENode> ites;
+    NodePool<WhileNode> whiles;
+    NodePool<ReturnNode> returns;
+    NodePool<StatSequenceNode> sequences;
+    NodePool<FunctionDeclNode> functions;
+
+    ListPool<std::pair<ArithmeticOperator, NodeRef<FactorNode> > > factor_lists;
+    ListPool<std::pair<ArithmeticOperator, NodeRef<TermNode> > > term_lists;
+    ListPool<NodeRef<ExpressionNode> > expression_lists;
+    ListPool<StatementNode> statement_lists;
+
+    std::size_t BytesAllocated() const;
+    void Clear();
+
+    PoolOffsets Sizes() const;
+    // Adds every node of other after the nodes of this pool. Lists which are
+    // still open in other are not copied.
+    void Append(const ASTPool& other);
 };
 ////////////////////////////////
 
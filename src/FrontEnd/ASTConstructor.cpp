@@ -1,5 +1,7 @@
 #include "ASTConstructor.h"
 
+#include "Papyrus/ThreadPool.h"
+
 using namespace papyrus;
 
 #define MUSTPARSE(x) MustParseToken(x, __func__, __LINE__)
@@ -18,7 +20,7 @@ void ASTConstructor::RaiseParseError(const std::string& error_msg) const {
     exit(1);
 }
 
-bool ASTConstructor::MustParseToken(const Lexer::Token& expected_tok, const std::string& func, int line) const {
+bool ASTConstructor::MustParseToken(const Lexer::Token& expected_tok, const char* func, int line) const {
     if (expected_tok != CurrentToken()) {
         LOG(ERROR) << "[DEBUG] " << func << ", Line: " << std::to_string(line);
         RaiseParseError(expected_tok);
@@ -27,46 +29,44 @@ bool ASTConstructor::MustParseToken(const Lexer::Token& expected_tok, const std:
 }
 
 ////////////////////////////////
-void ASTConstructor::AddSymbol(const IdentifierNode* ident, const TypeDeclNode* type_decl) {
-    Symbol *s = new Symbol(ident->IdentifierName(),
-                           type_decl->GetDimensions(),
-                           type_decl->IsArray(),
+void ASTConstructor::AddSymbol(SymbolId ident, const TypeDeclNode& type_decl) {
+    if (current_scope_ == "global" ? IsGlobal(ident) : IsLocal(ident)) {
+        RaiseParseError("Redeclaration of variable " + SymbolName(ident));
+    }
+
+    Symbol *s = new Symbol(ident,
+                           type_decl.GetDimensions(),
+                           type_decl.IsArray(),
                            current_scope_ == "global",
                            false);
 
     if (current_scope_ == "global") {
-        global_symbol_table_.push_back(std::make_pair(ident->IdentifierName(), s));
+        global_symbol_table_.Declare(ident, s);
     } else {
-        local_symbol_table_.push_back(std::make_pair(ident->IdentifierName(), s));
+        local_symbol_table_.Declare(ident, s);
     }
 }
 
-void ASTConstructor::AddFormalSymbol(const IdentifierNode* ident) {
-    Symbol* s = new Symbol(ident->IdentifierName(),
+void ASTConstructor::AddFormalSymbol(SymbolId ident) {
+    if (IsLocal(ident)) {
+        RaiseParseError("Redeclaration of formal parameter " + SymbolName(ident));
+    }
+
+    Symbol* s = new Symbol(ident,
                            {},
                            false,
                            false,
                            true);
                             
-    local_symbol_table_.push_back(std::make_pair(ident->IdentifierName(), s));
+    local_symbol_table_.Declare(ident, s);
 }
 
-bool ASTConstructor::IsGlobal(const std::string& identifier) const {
-    return std::find_if(global_symbol_table_.begin(), global_symbol_table_.end(), 
-            [&identifier](const std::pair<std::string, Symbol*>& elem) {
-            return elem.first == identifier;
-        }) == global_symbol_table_.end();;
+bool ASTConstructor::IsGlobal(SymbolId identifier) const {
+    return global_symbol_table_.LookupLocal(identifier) != nullptr;
 }
 
-bool ASTConstructor::IsLocal(const std::string& identifier) const {
-    return std::find_if(local_symbol_table_.begin(), local_symbol_table_.end(), 
-            [&identifier](const std::pair<std::string, Symbol*>& elem) {
-            return elem.first == identifier;
-        }) == local_symbol_table_.end();
-}
-
-bool ASTConstructor::IsDefined(const std::string& identifier) const {
-    return IsGlobal(identifier) || IsLocal(identifier);
+bool ASTConstructor::IsLocal(SymbolId identifier) const {
+    return local_symbol_table_.LookupLocal(identifier) != nullptr;
 }
 
 ////////////////////////////////
@@ -89,28 +89,25 @@ bool ASTConstructor::IsExpressionBegin(const Lexer::Token& token) const {
 ////////////////////////////////
 // Rule: ident = letter {letter | digit}.
 ////////////////////////////////
-IdentifierNode* ASTConstructor::ParseIdentifier() {
+SymbolId ASTConstructor::ParseIdentifier() {
     FetchToken();
     MUSTPARSE(Lexer::TOK_IDENT);
 
-    std::string identifier_name = GetBuffer();
-    IdentifierNode* ident = new IdentifierNode(identifier_name);
-    
-    return ident;
+    return GetSymbol();
 }
 
 ////////////////////////////////
 // Rule: typeDecl = “var” | “array” “[“ number “]” { “[“ number “]” }.
 ////////////////////////////////
-TypeDeclNode* ASTConstructor::ParseTypeDecl() {
+TypeDeclNode ASTConstructor::ParseTypeDecl() {
     FetchToken();
 
-    TypeDeclNode* type_decl = new TypeDeclNode();
+    TypeDeclNode type_decl;
 
     if (Lexer::TOK_VAR == CurrentToken()) {
-        type_decl->SetIfArray(false);
+        type_decl.SetIfArray(false);
     } else if (Lexer::TOK_ARRAY == CurrentToken()) {
-        type_decl->SetIfArray(true);
+        type_decl.SetIfArray(true);
 
         FetchToken();
         MUSTPARSE(Lexer::TOK_SQUARE_OPEN);
@@ -118,21 +115,18 @@ TypeDeclNode* ASTConstructor::ParseTypeDecl() {
         FetchToken();
         MUSTPARSE(Lexer::TOK_NUM);
 
-        ConstantNode* arr_dimension = new ConstantNode(ParseCurrentTokenAsNumber());
+        type_decl.AddArrayDimension(ParseCurrentTokenAsNumber());
 
         FetchToken();
         MUSTPARSE(Lexer::TOK_SQUARE_CLOSED);
 
-        type_decl->AddArrayDimension(arr_dimension);
-
         while (Lexer::TOK_SQUARE_OPEN == PeekNextToken()) {
             FetchToken();
 
             FetchToken();
             MUSTPARSE(Lexer::TOK_NUM);
 
-            arr_dimension = new ConstantNode(ParseCurrentTokenAsNumber());
-            type_decl->AddArrayDimension(arr_dimension);
+            type_decl.AddArrayDimension(ParseCurrentTokenAsNumber());
 
             FetchToken();
             MUSTPARSE(Lexer::TOK_SQUARE_CLOSED);
@@ -148,15 +142,13 @@ TypeDeclNode* ASTConstructor::ParseTypeDecl() {
 // Rule: varDecl = typeDecl ident { “,” ident } “;”
 ////////////////////////////////
 void ASTConstructor::ParseVariableDecl() {
-    TypeDeclNode* type_decl = ParseTypeDecl();
-    IdentifierNode* ident = ParseIdentifier();
+    TypeDeclNode type_decl = ParseTypeDecl();
 
-    AddSymbol(ident, type_decl);
+    AddSymbol(ParseIdentifier(), type_decl);
 
     while (Lexer::TOK_COMMA == PeekNextToken()) {
         FetchToken();
-        ident = ParseIdentifier();
-        AddSymbol(ident, type_decl);
+        AddSymbol(ParseIdentifier(), type_decl);
     }
 
     FetchToken();
@@ -171,13 +163,11 @@ void ASTConstructor::ParseFormalParameters() {
     MUSTPARSE(Lexer::TOK_ROUND_OPEN);
 
     if (Lexer::TOK_IDENT == PeekNextToken()) {
-        IdentifierNode* ident = ParseIdentifier();
-        AddFormalSymbol(ident);
+        AddFormalSymbol(ParseIdentifier());
 
         while (Lexer::TOK_COMMA == PeekNextToken()) {
             FetchToken();
-            ident = ParseIdentifier();
-            AddFormalSymbol(ident);
+            AddFormalSymbol(ParseIdentifier());
         }
     }
 
@@ -188,26 +178,26 @@ void ASTConstructor::ParseFormalParameters() {
 ////////////////////////////////
 // Rule: factor = designator | number | “(“ expression “)” | funcCall .
 ////////////////////////////////
-FactorNode* ASTConstructor::ParseFactor() {
-    FactorNode* fact;
+NodeRef<FactorNode> ASTConstructor::ParseFactor() {
+    NodeRef<FactorNode> fact;
 
     if (Lexer::TOK_IDENT == PeekNextToken()) {
-        fact = new FactorNode(ParseDesignator());
+        fact = nodes_.factors.Add(FactorNode(ParseDesignator()));
     } else if (Lexer::TOK_NUM == PeekNextToken()) {
         FetchToken();
 
-        fact = new FactorNode(new ConstantNode(ParseCurrentTokenAsNumber()));
+        fact = nodes_.factors.Add(FactorNode(static_cast<int>(ParseCurrentTokenAsNumber())));
     } else if (Lexer::TOK_ROUND_OPEN == PeekNextToken()) {
         FetchToken();
 
-        fact = new FactorNode(ParseExpression());
+        fact = nodes_.factors.Add(FactorNode(ParseExpression()));
 
         FetchToken();
         MUSTPARSE(Lexer::TOK_ROUND_CLOSED);
     } else if (Lexer::TOK_CALL == PeekNextToken()) {
         FetchToken();
 
-        fact = new FactorNode(ParseFunctionCall());
+        fact = nodes_.factors.Add(FactorNode(ParseFunctionCall()));
     } else {
         RaiseParseError("Could not parse factor.");
     }
@@ -218,91 +208,96 @@ FactorNode* ASTConstructor::ParseFactor() {
 ////////////////////////////////
 // Rule: term = factor { (“*” | “/”) factor}.
 ////////////////////////////////
-TermNode* ASTConstructor::ParseTerm() {
-    TermNode* term = new TermNode(ParseFactor());
-    
+NodeRef<TermNode> ASTConstructor::ParseTerm() {
+    NodeRef<FactorNode> primary = ParseFactor();
+
+    auto mark = nodes_.factor_lists.Open();
     while (Lexer::TOK_BINOP_MUL == PeekNextToken() ||
            Lexer::TOK_BINOP_DIV == PeekNextToken()) {
         FetchToken();
 
         auto op = GetBinOperatorForToken(CurrentToken());
-        term->AddSecondaryFactor(op, ParseFactor());
+        nodes_.factor_lists.Push(std::make_pair(op, ParseFactor()));
     }
 
-    return term;
+    return nodes_.terms.Add(TermNode(primary, nodes_.factor_lists.Close(mark)));
 }
 
 ////////////////////////////////
 // Rule: expression = term {(“+” | “-”) term}.
 ////////////////////////////////
-ExpressionNode* ASTConstructor::ParseExpression() {
-    ExpressionNode* expr = new ExpressionNode(ParseTerm());
+NodeRef<ExpressionNode> ASTConstructor::ParseExpression() {
+    NodeRef<TermNode> primary = ParseTerm();
 
+    auto mark = nodes_.term_lists.Open();
     while (Lexer::TOK_BINOP_ADD == PeekNextToken() ||
            Lexer::TOK_BINOP_SUB == PeekNextToken()) {
         FetchToken();
 
         auto op = GetBinOperatorForToken(CurrentToken());
-        expr->AddSecondaryTerm(op, ParseTerm());
+        nodes_.term_lists.Push(std::make_pair(op, ParseTerm()));
     }
 
-    return expr;
+    return nodes_.expressions.Add(ExpressionNode(primary, nodes_.term_lists.Close(mark)));
 }
 
 ////////////////////////////////
 // Rule: designator = ident{ "[" expression "]" }.
 ////////////////////////////////
-DesignatorNode* ASTConstructor::ParseDesignator() {
-    IdentifierNode* ident = ParseIdentifier();
+NodeRef<DesignatorNode> ASTConstructor::ParseDesignator() {
+    SymbolId ident = ParseIdentifier();
 
     if (Lexer::TOK_SQUARE_OPEN == PeekNextToken()) {
-        ArrIdentifierNode* designator = new ArrIdentifierNode(ident);
-
-        while (Lexer::TOK_SQUARE_OPEN == PeekNextToken()) {
-            FetchToken();
-            designator->AddIndirectionToArray(ParseExpression());
-
-            FetchToken();
-            MUSTPARSE(Lexer::TOK_SQUARE_CLOSED);
-        }
-
-        return designator;
+        return ParseIndirections(ident);
     } else {
-        VarIdentifierNode* designator = new VarIdentifierNode(ident);
+        return nodes_.designators.Add(DesignatorNode(ident));
+    }
+}
 
-        return designator;
+// The "[" expression "]" part of an array designator
+NodeRef<DesignatorNode> ASTConstructor::ParseIndirections(SymbolId ident) {
+    auto mark = nodes_.expression_lists.Open();
+    while (Lexer::TOK_SQUARE_OPEN == PeekNextToken()) {
+        FetchToken();
+        nodes_.expression_lists.Push(ParseExpression());
+
+        FetchToken();
+        MUSTPARSE(Lexer::TOK_SQUARE_CLOSED);
     }
+
+    return nodes_.designators.Add(DesignatorNode(ident, nodes_.expression_lists.Close(mark)));
 }
 
 ////////////////////////////////
 // Rule: assignment = “let” designator “<-” expression.
 ////////////////////////////////
-AssignmentNode* ASTConstructor::ParseAssignment() {
-    DesignatorNode* desig = ParseDesignator();
+NodeRef<AssignmentNode> ASTConstructor::ParseAssignment() {
+    NodeRef<DesignatorNode> desig = ParseDesignator();
 
     FetchToken();
     MUSTPARSE(Lexer::TOK_LEFTARROW);
 
-    ExpressionNode* value = ParseExpression();
+    NodeRef<ExpressionNode> value = ParseExpression();
 
-    return new AssignmentNode(desig, value);
+    return nodes_.assignments.Add(AssignmentNode(desig, value));
 }
 
 ////////////////////////////////
 // Rule: funcCall = “call” ident [ “(“ [expression { “,” expression } ] “)” ].
 ////////////////////////////////
-FunctionCallNode* ASTConstructor::ParseFunctionCall() {
-    FunctionCallNode* func_call = new FunctionCallNode(ParseIdentifier());
+NodeRef<FunctionCallNode> ASTConstructor::ParseFunctionCall() {
+    SymbolId ident = ParseIdentifier();
 
+    auto mark = nodes_.expression_lists.Open();
     if (Lexer::TOK_ROUND_OPEN == PeekNextToken()) {
         FetchToken();
 
         if (IsExpressionBegin(PeekNextToken())) {
-            func_call->AddArgument(ParseExpression());
+            nodes_.expression_lists.Push(ParseExpression());
 
             while (Lexer::TOK_COMMA == PeekNextToken()) {
                 FetchToken();
-                func_call->AddArgument(ParseExpression());
+                nodes_.expression_lists.Push(ParseExpression());
             }
         }
 
@@ -310,14 +305,14 @@ FunctionCallNode* ASTConstructor::ParseFunctionCall() {
         MUSTPARSE(Lexer::TOK_ROUND_CLOSED);
     }
 
-    return func_call;
+    return nodes_.calls.Add(FunctionCallNode(ident, nodes_.expression_lists.Close(mark)));
 }
 
 ////////////////////////////////
 // Rule: relation = expression relOp expression .
 ////////////////////////////////
-RelationNode* ASTConstructor::ParseRelation() {
-    ExpressionNode* left_expr = ParseExpression();
+NodeRef<RelationNode> ASTConstructor::ParseRelation() {
+    NodeRef<ExpressionNode> left_expr = ParseExpression();
 
     if (!IsRelationalOp(PeekNextToken())) {
         RaiseParseError("Expected relational operator in relation");
@@ -326,111 +321,106 @@ RelationNode* ASTConstructor::ParseRelation() {
     FetchToken();
     RelationalOperator rel_op = GetRelOperatorForToken(CurrentToken());
 
-    ExpressionNode* right_expr = ParseExpression();
+    NodeRef<ExpressionNode> right_expr = ParseExpression();
 
-    return new RelationNode(left_expr, rel_op, right_expr);
+    return nodes_.relations.Add(RelationNode(left_expr, rel_op, right_expr));
 }
 
 ////////////////////////////////
 // Rule: ifStatement = “if” relation “then” statSequence [ “else” statSequence ] “fi”.
 ////////////////////////////////
-ITENode* ASTConstructor::ParseITE() {
-    RelationNode* condition = ParseRelation();
+NodeRef<ITENode> ASTConstructor::ParseITE() {
+    NodeRef<RelationNode> condition = ParseRelation();
     
     FetchToken();
     MUSTPARSE(Lexer::TOK_THEN);
 
-    StatSequenceNode* if_clause = ParseStatementSequence();
-
-    ITENode* ite = new ITENode(condition, if_clause);
+    NodeRef<StatSequenceNode> if_clause = ParseStatementSequence();
+    NodeRef<StatSequenceNode> else_clause;
 
     if (Lexer::TOK_ELSE == PeekNextToken()) {
         FetchToken();
-        ite->AddElseClause(ParseStatementSequence());
+        else_clause = ParseStatementSequence();
     }
 
     FetchToken();
     MUSTPARSE(Lexer::TOK_FI);
 
-    return ite;
+    return nodes_.ites.Add(ITENode(condition, if_clause, else_clause));
 }
 
 ////////////////////////////////
 // Rule: whileStatement = “while” relation “do” StatSequence “od”.
 ////////////////////////////////
-WhileNode* ASTConstructor::ParseWhile() {
-    RelationNode* loop_condition = ParseRelation();
+NodeRef<WhileNode> ASTConstructor::ParseWhile() {
+    NodeRef<RelationNode> loop_condition = ParseRelation();
 
     FetchToken();
     MUSTPARSE(Lexer::TOK_DO);
 
-    StatSequenceNode* loop_body = ParseStatementSequence();
+    NodeRef<StatSequenceNode> loop_body = ParseStatementSequence();
     
     FetchToken();
     MUSTPARSE(Lexer::TOK_OD);
 
-    return new WhileNode(loop_condition, loop_body);
+    return nodes_.whiles.Add(WhileNode(loop_condition, loop_body));
 }
 
 ////////////////////////////////
 // Rule: returnStatement = “return” [ expression ] .
 ////////////////////////////////
-ReturnNode* ASTConstructor::ParseReturn() {
-    ReturnNode* ret = new ReturnNode();
+NodeRef<ReturnNode> ASTConstructor::ParseReturn() {
+    NodeRef<ExpressionNode> return_expression;
 
     if (IsExpressionBegin(PeekNextToken())) {
-        ret->AddReturnExpression(ParseExpression());
+        return_expression = ParseExpression();
     }
 
-    return ret;
+    return nodes_.returns.Add(ReturnNode(return_expression));
 }
 
 ////////////////////////////////
 // Rule: statement = assignment | funcCall | ifStatement | whileStatement | returnStatement.
 ////////////////////////////////
-StatementNode* ASTConstructor::ParseStatement() {
-    StatementNode* statement;
-
+StatementNode ASTConstructor::ParseStatement() {
     FetchToken();
     if (Lexer::TOK_LET == CurrentToken()) {
-        statement = static_cast<StatementNode*>(ParseAssignment());
+        return StatementNode(STAT_ASSIGN, ParseAssignment().Index());
     } else if (Lexer::TOK_CALL == CurrentToken()) {
-        statement = static_cast<StatementNode*>(ParseFunctionCall());
+        return StatementNode(STAT_FUNCCALL, ParseFunctionCall().Index());
     } else if (Lexer::TOK_IF == CurrentToken()) {
-        statement = static_cast<StatementNode*>(ParseITE());
+        return StatementNode(STAT_ITE, ParseITE().Index());
     } else if (Lexer::TOK_WHILE == CurrentToken()) {
-        statement = static_cast<StatementNode*>(ParseWhile());
+        return StatementNode(STAT_WHILE, ParseWhile().Index());
     } else if (Lexer::TOK_RETURN == CurrentToken()) {
-        statement = static_cast<StatementNode*>(ParseReturn());
+        return StatementNode(STAT_RETURN, ParseReturn().Index());
     } else {
         RaiseParseError("Statement not valid");
     }
 
-    return statement;
+    return StatementNode(STAT_NONE, NO_NODE);
 }
 
 ////////////////////////////////
 // Rule: statSequence = statement { “;” statement }.
 ////////////////////////////////
-StatSequenceNode* ASTConstructor::ParseStatementSequence() {
-    StatSequenceNode* stat_seq = new StatSequenceNode();
+NodeRef<StatSequenceNode> ASTConstructor::ParseStatementSequence() {
+    auto mark = nodes_.statement_lists.Open();
 
-    stat_seq->AddStatementToSequence(ParseStatement());
+    nodes_.statement_lists.Push(ParseStatement());
 
     while (Lexer::TOK_SEMICOLON == PeekNextToken()) {
         FetchToken();
-        stat_seq->AddStatementToSequence(ParseStatement());
+        nodes_.statement_lists.Push(ParseStatement());
     }
 
-    return stat_seq;
+    return nodes_.sequences.Add(StatSequenceNode(nodes_.statement_lists.Close(mark)));
 }
 
 ////////////////////////////////
 // Rule: funcBody = { varDecl } “{” [ statSequence ] “}”.
 ////////////////////////////////
-FunctionBodyNode* ASTConstructor::ParseFunctionBody() {
-    FunctionBodyNode* func_body = new FunctionBodyNode();
-
+NodeRef<StatSequenceNode> ASTConstructor::ParseFunctionBody() {
     while (Lexer::TOK_VAR == PeekNextToken() ||
         Lexer::TOK_ARRAY == PeekNextToken()) {
         ParseVariableDecl();
@@ -440,23 +430,22 @@ FunctionBodyNode* ASTConstructor::ParseFunctionBody() {
     MUSTPARSE(Lexer::TOK_CURLY_OPEN);
 
 
-    StatSequenceNode* stat_sequence = ParseStatementSequence();
-    func_body->SetFunctionBodyStatSequence(stat_sequence);
+    NodeRef<StatSequenceNode> stat_sequence = ParseStatementSequence();
 
     FetchToken();
     MUSTPARSE(Lexer::TOK_CURLY_CLOSED);
 
-    return func_body;
+    return stat_sequence;
 }
 
 ////////////////////////////////
 // Rule: funcDecl = (“function” | “procedure”) ident [formalParam] “;” funcBody “;” .
 ////////////////////////////////
-FunctionDeclNode* ASTConstructor::ParseFunctionDecl() {
-    IdentifierNode* ident = ParseIdentifier();
+NodeRef<FunctionDeclNode> ASTConstructor::ParseFunctionDecl() {
+    SymbolId ident = ParseIdentifier();
 
     ////////////////////////////////////////////
-    current_scope_ = ident->IdentifierName();
+    current_scope_ = SymbolName(ident);
     symbol_table_[current_scope_] = {};
     ////////////////////////////////////////////
 
@@ -467,9 +456,9 @@ FunctionDeclNode* ASTConstructor::ParseFunctionDecl() {
     FetchToken();
     MUSTPARSE(Lexer::TOK_SEMICOLON);
 
-    FunctionBodyNode* func_body = ParseFunctionBody();
+    NodeRef<StatSequenceNode> func_body = ParseFunctionBody();
 
-    FunctionDeclNode* func_decl = new FunctionDeclNode(ident, func_body);
+    NodeRef<FunctionDeclNode> func_decl = nodes_.functions.Add(FunctionDeclNode(ident, func_body));
 
     FetchToken();
     MUSTPARSE(Lexer::TOK_SEMICOLON);
@@ -477,9 +466,155 @@ FunctionDeclNode* ASTConstructor::ParseFunctionDecl() {
     return func_decl;
 }
 
+////////////////////////////////
+// Rule: { funcDecl }
+////////////////////////////////
+void ASTConstructor::ParseFunctionDecls() {
+    while (Lexer::TOK_FUNCTION == PeekNextToken() ||
+           Lexer::TOK_PROCEDURE == PeekNextToken()) {
+        FetchToken();
+
+        ParseFunctionDecl();
+
+        symbol_table_[current_scope_] = std::move(local_symbol_table_);
+        local_symbol_table_.clear();
+    }
+}
+
+// Finds where each of the declarations in { funcDecl } starts, without
+// parsing them. Since function bodies cannot nest, a declaration ends at the
+// first "}" ";". Returns the first token after the declarations.
+TokenRecord ASTConstructor::ScanFunctionDecls(Lexer& scanner, std::vector<TokenRecord>& decl_starts) {
+    bool in_decl = false;
+    Lexer::Token previous = Lexer::TOK_NONE;
+
+    while (true) {
+        Lexer::Token tok = scanner.GetNextToken();
+        TokenRecord record = {tok, scanner.GetBuffer(), scanner.GetLineNo(), scanner.GetSymbol()};
+
+        if (!in_decl) {
+            if (Lexer::TOK_FUNCTION != tok && Lexer::TOK_PROCEDURE != tok) {
+                return record;
+            }
+
+            decl_starts.push_back(record);
+            in_decl = true;
+        } else if (Lexer::TOK_EOF == tok) {
+            // Unterminated declaration, the parse reports it
+            return record;
+        } else if (Lexer::TOK_CURLY_CLOSED == previous && Lexer::TOK_SEMICOLON == tok) {
+            in_decl = false;
+        }
+
+        previous = tok;
+    }
+}
+
+// Parses { funcDecl } on a ThreadPool. The declarations are split into
+// chunks of consecutive declarations of about the same size, each of which
+// is parsed by its own ASTConstructor into its own pools. The chunks are
+// then appended to nodes_ in source order, so the result is the same as
+// that of ParseFunctionDecls().
+//
+// A parse error in a declaration is reported as usual. If there are errors
+// in several chunks, which of them is reported is not deterministic.
+void ASTConstructor::ParseFunctionDeclsInParallel() {
+    if (Lexer::TOK_FUNCTION != PeekNextToken() &&
+        Lexer::TOK_PROCEDURE != PeekNextToken()) {
+        return;
+    }
+
+    // The scan lexes every declaration once on this thread. This interns
+    // their identifiers in source order (SymbolIds are the same as for a
+    // serial parse), after which the workers only look identifiers up. The
+    // Interner is frozen while they run, see Interner.h.
+    const TokenRecord& first_decl = tokens_.Peek();
+    Lexer scanner(first_decl.span.data(), lexer_instance_.InputEnd(), first_decl.line_no);
+
+    std::vector<TokenRecord> decl_starts;
+    TokenRecord after_decls = ScanFunctionDecls(scanner, decl_starts);
+
+    // A few chunks per thread even out declarations of different sizes
+    const unsigned CHUNKS_PER_THREAD = 4;
+
+    unsigned num_threads = parse_jobs_ == 0 ? ThreadPool::DefaultThreads() : parse_jobs_;
+    std::size_t max_chunks = std::min<std::size_t>(decl_starts.size(), num_threads * CHUNKS_PER_THREAD);
+
+    const char* decls_begin = decl_starts.front().span.data();
+    const char* decls_end   = after_decls.span.data();
+    std::size_t total_size  = decls_end - decls_begin;
+
+    // Index of the first declaration of each chunk
+    std::vector<std::size_t> chunk_starts;
+    for (std::size_t idx = 0; idx < decl_starts.size(); idx++) {
+        std::size_t offset = decl_starts[idx].span.data() - decls_begin;
+        if (offset >= chunk_starts.size() * total_size / max_chunks) {
+            chunk_starts.push_back(idx);
+        }
+    }
+
+    std::vector<std::unique_ptr<Lexer> > chunk_lexers(chunk_starts.size());
+    std::vector<std::unique_ptr<ASTConstructor> > chunk_parsers(chunk_starts.size());
+
+    Interner::Global().Freeze();
+    {
+        ThreadPool pool(num_threads);
+
+        for (std::size_t chunk = 0; chunk < chunk_starts.size(); chunk++) {
+            const TokenRecord& start = decl_starts[chunk_starts[chunk]];
+            const char* end = chunk + 1 < chunk_starts.size() ?
+                              decl_starts[chunk_starts[chunk + 1]].span.data() :
+                              decls_end;
+
+            pool.Submit([this, &chunk_lexers, &chunk_parsers, &start, end, chunk]() {
+                chunk_lexers[chunk].reset(new Lexer(start.span.data(), end, start.line_no));
+                chunk_parsers[chunk].reset(new ASTConstructor(*chunk_lexers[chunk], &global_symbol_table_));
+
+                ASTConstructor& parser = *chunk_parsers[chunk];
+                parser.ParseFunctionDecls();
+
+                parser.FetchToken();
+                parser.MustParseToken(Lexer::TOK_EOF, __func__, __LINE__);
+            });
+        }
+
+        pool.Wait();
+    }
+    Interner::Global().Thaw();
+
+    for (auto& parser: chunk_parsers) {
+        nodes_.Append(parser->nodes_);
+
+        // Later declarations of a name replace earlier ones, as in
+        // ParseFunctionDecls()
+        for (auto& scope: parser->symbol_table_) {
+            symbol_table_[scope.first] = std::move(scope.second);
+        }
+    }
+
+    // Continue after the declarations
+    lexer_instance_.Seek(after_decls.span.data(), after_decls.line_no);
+    tokens_.Reset();
+}
+
 ASTConstructor::ASTConstructor(Lexer& lexer) :
+    local_symbol_table_(&global_symbol_table_),
     lexer_instance_(lexer),
-    is_peek_(false) {}
+    tokens_(lexer),
+    parse_jobs_(1) {}
+
+ASTConstructor::ASTConstructor(Lexer& lexer, const SymbolTable* enclosing_scope) :
+    local_symbol_table_(enclosing_scope),
+    lexer_instance_(lexer),
+    tokens_(lexer),
+    parse_jobs_(1) {}
+
+// Drops the AST in one go. Symbols are not AST nodes and outlive it since
+// the IR refers to them.
+void ASTConstructor::Reset() {
+    root_ = ComputationNode();
+    nodes_.Clear();
+}
 
 ////////////////////////////////
 // Rule: computation = “main” { varDecl } { funcDecl } “{” statSequence “}” “.” .
@@ -488,7 +623,7 @@ void ASTConstructor::ConstructAST() {
     FetchToken();
     MUSTPARSE(Lexer::TOK_MAIN);
 
-    ComputationNode* root = new ComputationNode();
+    ComputationNode root;
 
     ////////////////////////////////////////////
     current_scope_ = "global";
@@ -498,24 +633,21 @@ void ASTConstructor::ConstructAST() {
         ParseVariableDecl();
     }
 
-    while (Lexer::TOK_FUNCTION == PeekNextToken() ||
-           Lexer::TOK_PROCEDURE == PeekNextToken()) {
-        FetchToken();
-
-        root->AddFunctionDecl(ParseFunctionDecl());
-
-        symbol_table_[current_scope_] = local_symbol_table_;
-        local_symbol_table_.clear();
+    // The declarations are added to nodes_.functions in order
+    if (parse_jobs_ != 1) {
+        ParseFunctionDeclsInParallel();
+    } else {
+        ParseFunctionDecls();
     }
 
     FetchToken();
     MUSTPARSE(Lexer::TOK_CURLY_OPEN);
-    
+
     ////////////////////////////////////////////
     current_scope_ = "global";
     ////////////////////////////////////////////
     if (Lexer::TOK_CURLY_CLOSED != PeekNextToken()) {
-        root->SetComputationBody(ParseStatementSequence());
+        root.SetComputationBody(ParseStatementSequence());
     }
 
     FetchToken();
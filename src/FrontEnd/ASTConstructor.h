@@ -5,11 +5,14 @@
 #include "Operation.h"
 #include "AST.h"
 #include "Lexer.h"
+#include "TokenBuffer.h"
+#include "SymbolTable.h"
 #include "IR/Variable.h"
 
 #include <algorithm>
 #include <memory>
 #include <map>
+#include <vector>
     
 namespace papyrus {
 
@@ -18,61 +21,50 @@ class ASTConstructor {
 public:
     ASTConstructor(Lexer&);
     void ConstructAST();
-    const ComputationNode* GetRoot() const { return root_; }
+    void Reset();
 
-    std::vector<std::pair<std::string, Symbol*> > GetGlobalSymTable() {
+    // Number of threads parsing the function declarations. With 1 (the
+    // default) they are parsed in order on the calling thread, 0 uses one
+    // thread per core.
+    void SetParseJobs(unsigned jobs) { parse_jobs_ = jobs; }
+    const ComputationNode* GetRoot() const { return &root_; }
+    const ASTPool& Nodes() const { return nodes_; }
+
+    const SymbolTable& GetGlobalSymTable() const {
         return global_symbol_table_;
     }
 
-    std::vector<std::pair<std::string, Symbol*> > GetLocalSymTable(const std::string& func_name) {
+    const SymbolTable& GetLocalSymTable(const std::string& func_name) const {
         return symbol_table_.at(func_name);
     }
 
-private:
+protected:
+    // Parses declarations of functions whose scopes are enclosed by
+    // enclosing_scope
+    ASTConstructor(Lexer&, const SymbolTable* enclosing_scope);
+
     ////////////////////////////////
     Lexer::Token CurrentToken() const {
-        if (is_peek_) {
-            return current_token_;
-        } else {
-            return lexer_instance_.GetToken();
-        }
+        return tokens_.Current().kind;
     }
     Lexer::Token FetchToken() { 
-        if (is_peek_) {
-            is_peek_ = false;
-            return lexer_instance_.GetToken();
-        } else {
-            return lexer_instance_.GetNextToken();
-        }
+        tokens_.Advance();
+        return tokens_.Current().kind;
     }
     Lexer::Token PeekNextToken() {
-        if (is_peek_) {
-            return lexer_instance_.GetToken();
-        } else {
-            current_token_ = lexer_instance_.GetToken();
-            current_buffer_ = lexer_instance_.GetBuffer();
-            current_line_no_ = lexer_instance_.GetLineNo();
-
-            is_peek_ = true;
-            return lexer_instance_.GetNextToken();
-        }
+        return tokens_.Peek().kind;
     }
     ////////////////////////////////
     
     ////////////////////////////////
-    const std::string& GetBuffer() const { 
-        if (is_peek_) {
-            return current_buffer_;
-        } else {
-            return lexer_instance_.GetBuffer();
-        }
+    std::string_view GetBuffer() const { 
+        return tokens_.Current().span;
+    }
+    SymbolId GetSymbol() const {
+        return tokens_.Current().symbol;
     }
     int GetLineNo() const { 
-        if (is_peek_) {
-            return current_line_no_;
-        } else {
-            return lexer_instance_.GetLineNo();
-        }
+        return tokens_.Current().line_no;
     }
     ////////////////////////////////
   
@@ -90,18 +82,19 @@ private:
         return lexer_instance_.GetBinOperatorForToken(tok);
     }
     long int ParseCurrentTokenAsNumber() const { 
-        if (is_peek_) {
-            return std::stol(current_buffer_);
-        } else {
-            return std::stol(lexer_instance_.GetBuffer());
+        // The Lexer guarantees that a TOK_NUM buffer only contains digits.
+        long int number = 0;
+        for (char digit: GetBuffer()) {
+            number = number * 10 + (digit - '0');
         }
+        return number;
     }
     ////////////////////////////////
    
     ////////////////////////////////
     void RaiseParseError(const Lexer::Token&) const;
     void RaiseParseError(const std::string&) const;
-    bool MustParseToken(const Lexer::Token&, const std::string&, int) const;
+    bool MustParseToken(const Lexer::Token&, const char*, int) const;
     ////////////////////////////////
 
     ////////////////////////////////
@@ -111,47 +104,53 @@ private:
 
     ///////////////////////////////
     std::string current_scope_;
-    std::map<std::string, std::vector<std::pair<std::string, Symbol*> > > symbol_table_;
+    std::map<std::string, SymbolTable> symbol_table_;
 
-    std::vector<std::pair<std::string, Symbol*> > local_symbol_table_;
-    std::vector<std::pair<std::string, Symbol*> > global_symbol_table_;
+    // The local scope is enclosed by the global scope
+    SymbolTable global_symbol_table_;
+    SymbolTable local_symbol_table_;
 
-    void AddSymbol(const IdentifierNode*, const TypeDeclNode*);
-    void AddFormalSymbol(const IdentifierNode*);
+    void AddSymbol(SymbolId, const TypeDeclNode&);
+    void AddFormalSymbol(SymbolId);
 
-    bool IsGlobal(const std::string&) const;
-    bool IsLocal(const std::string&) const;
-    bool IsDefined(const std::string&) const;
+    // Declared in the global scope, or in the scope of the function being
+    // parsed
+    bool IsGlobal(SymbolId) const;
+    bool IsLocal(SymbolId) const;
 
   
     ////////////////////////////////
-    IdentifierNode* ParseIdentifier();
-    FunctionDeclNode* ParseFunctionDecl();
-    FunctionBodyNode* ParseFunctionBody();
-    StatSequenceNode* ParseStatementSequence();
-    StatementNode* ParseStatement();
-    AssignmentNode* ParseAssignment();
-    FunctionCallNode* ParseFunctionCall();
-    ITENode* ParseITE();
-    WhileNode* ParseWhile();
-    ReturnNode* ParseReturn();
-    ExpressionNode* ParseExpression();
-    DesignatorNode* ParseDesignator();
-    RelationNode* ParseRelation();
-    FactorNode* ParseFactor();
-    TermNode* ParseTerm();
-    TypeDeclNode* ParseTypeDecl();
+    SymbolId ParseIdentifier();
+    void ParseFunctionDecls();
+    void ParseFunctionDeclsInParallel();
+    static TokenRecord ScanFunctionDecls(Lexer&, std::vector<TokenRecord>&);
+    NodeRef<FunctionDeclNode> ParseFunctionDecl();
+    NodeRef<StatSequenceNode> ParseFunctionBody();
+    NodeRef<StatSequenceNode> ParseStatementSequence();
+    StatementNode ParseStatement();
+    NodeRef<AssignmentNode> ParseAssignment();
+    NodeRef<FunctionCallNode> ParseFunctionCall();
+    NodeRef<ITENode> ParseITE();
+    NodeRef<WhileNode> ParseWhile();
+    NodeRef<ReturnNode> ParseReturn();
+    NodeRef<ExpressionNode> ParseExpression();
+    NodeRef<DesignatorNode> ParseDesignator();
+    NodeRef<DesignatorNode> ParseIndirections(SymbolId);
+    NodeRef<RelationNode> ParseRelation();
+    NodeRef<FactorNode> ParseFactor();
+    NodeRef<TermNode> ParseTerm();
+    TypeDeclNode ParseTypeDecl();
     void ParseVariableDecl();
     void ParseFormalParameters();
     ////////////////////////////////
     Lexer& lexer_instance_;
+    TokenBuffer tokens_;
+    unsigned parse_jobs_;
     ////////////////////////////////
-    ComputationNode* root_;
-    ////////////////////////////////
-    bool is_peek_;
-    int current_line_no_;
-    Lexer::Token current_token_;
-    std::string current_buffer_;
+    // Every AST node lives in nodes_ and is released along with it, either
+    // when the ASTConstructor goes away or on Reset().
+    ASTPool nodes_;
+    ComputationNode root_;
     ////////////////////////////////
 };
 
@@ -0,0 +1,39 @@
+#include "Interner.h"
+
+#include "Papyrus/Logger/Logger.h"
+
+#include <cstdlib>
+
+using namespace papyrus;
+
+Interner& Interner::Global() {
+    static Interner interner;
+    return interner;
+}
+
+SymbolId Interner::Intern(std::string_view name) {
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+
+    if (frozen_) {
+        LOG(ERROR) << "[INTERNER] " << name << " interned while shared between threads";
+        exit(1);
+    }
+
+    SymbolId sym = static_cast<SymbolId>(names_.size());
+    names_.emplace_back(name);
+    ids_.emplace(names_.back(), sym);
+
+    return sym;
+}
+
+const std::string& Interner::Name(SymbolId sym) const {
+    static const std::string no_name;
+    if (sym == NO_SYMBOL) {
+        return no_name;
+    }
+
+    return names_.at(sym);
+}
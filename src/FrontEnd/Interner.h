@@ -0,0 +1,66 @@
+#ifndef PAPYRUS_INTERNER_H
+#define PAPYRUS_INTERNER_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace papyrus {
+
+using SymbolId = uint32_t;
+
+// Id of "no identifier", e.g. for Values which are not tied to a variable
+constexpr SymbolId NO_SYMBOL = UINT32_MAX;
+
+/*
+ * The Interner maps every identifier to a dense SymbolId. Identifiers are
+ * interned once by the Lexer; from there on the parser, symbol tables and
+ * the SSA construction compare and index by id instead of hashing strings.
+ * Ids are handed out in order of first appearance starting from 0, which
+ * allows tables keyed by identifier to be plain vectors.
+ *
+ * There is a single Interner for the whole compilation. Names are stored in
+ * a deque so that the references returned by Name() stay valid.
+ *
+ * The Interner is not locked. Threads may only share it while no new names
+ * are added: the parallel parse interns every identifier of the function
+ * declarations on one thread first, and freezes the Interner while the
+ * workers run. Interning a new name while frozen is a fatal error.
+ */
+class Interner {
+public:
+    static Interner& Global();
+
+    SymbolId Intern(std::string_view);
+    const std::string& Name(SymbolId) const;
+
+    std::size_t Size() const { return names_.size(); }
+
+    void Freeze() { frozen_ = true; }
+    void Thaw() { frozen_ = false; }
+
+private:
+    Interner() : frozen_(false) {}
+
+    std::atomic<bool> frozen_;
+
+    std::deque<std::string> names_;
+    // Keys are views into names_
+    std::unordered_map<std::string_view, SymbolId> ids_;
+};
+
+// Shorthands for the global Interner
+inline SymbolId Intern(std::string_view name) {
+    return Interner::Global().Intern(name);
+}
+
+inline const std::string& SymbolName(SymbolId sym) {
+    return Interner::Global().Name(sym);
+}
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_INTERNER_H */
@@ -1,125 +1,239 @@
 #include "Lexer.h"
+#include "Scan.h"
+
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace papyrus;
 
-#define RESERVE_WORD(a, b) reserved_words_.insert({a,b})
+namespace {
+
+//////////////////////////////
+// Reserved words in the language
+//
+// Keywords are looked up through a perfect hash which is checked at compile
+// time. (length + 3 * first character) mod 32 happens to be collision-free
+// for the keyword set, so a lookup is one table load and one comparison.
+//////////////////////////////
+struct Keyword {
+    std::string_view spelling;
+    Lexer::Token token;
+};
+
+constexpr Keyword keywords[] = {
+    {"main",      Lexer::TOK_MAIN},
+    {"let",       Lexer::TOK_LET},
+    {"call",      Lexer::TOK_CALL},
+    {"if",        Lexer::TOK_IF},
+    {"then",      Lexer::TOK_THEN},
+    {"else",      Lexer::TOK_ELSE},
+    {"fi",        Lexer::TOK_FI},
+    {"while",     Lexer::TOK_WHILE},
+    {"do",        Lexer::TOK_DO},
+    {"od",        Lexer::TOK_OD},
+    {"return",    Lexer::TOK_RETURN},
+    {"var",       Lexer::TOK_VAR},
+    {"array",     Lexer::TOK_ARRAY},
+    {"function",  Lexer::TOK_FUNCTION},
+    {"procedure", Lexer::TOK_PROCEDURE},
+};
+
+constexpr std::size_t KEYWORD_SLOTS = 32;
+
+constexpr std::size_t KeywordHash(std::string_view word) {
+    return (word.size() + 3 * static_cast<unsigned char>(word[0])) % KEYWORD_SLOTS;
+}
+
+struct KeywordTable {
+    Keyword slots[KEYWORD_SLOTS];
+    bool is_perfect;
+};
+
+constexpr KeywordTable MakeKeywordTable() {
+    KeywordTable table = {};
+    table.is_perfect = true;
+
+    for (const auto& keyword: keywords) {
+        auto& slot = table.slots[KeywordHash(keyword.spelling)];
+        if (!slot.spelling.empty()) {
+            table.is_perfect = false;
+        }
+        slot = keyword;
+    }
+
+    return table;
+}
+
+constexpr KeywordTable keyword_table = MakeKeywordTable();
+static_assert(keyword_table.is_perfect, "Keyword hash has collisions");
+
+// Identifiers are never empty, so empty slots never match.
+Lexer::Token LookupKeyword(std::string_view word) {
+    const Keyword& slot = keyword_table.slots[KeywordHash(word)];
+    return slot.spelling == word ? slot.token : Lexer::TOK_IDENT;
+}
+
+} // namespace
 
 //////////////////////////////
 Lexer::Lexer(std::istream &i_buf) : 
-    input_buffer_(i_buf),
-    current_buffer_(),
+    stream_contents_(std::istreambuf_iterator<char>(i_buf),
+                     std::istreambuf_iterator<char>()),
+    mapping_(nullptr),
+    mapping_size_(0),
+    token_offset_(0),
+    token_length_(0),
     current_lineno_(1),
-    ch_('\0'),
-    last_char_(' '),
     current_token_(Lexer::TOK_NONE),
-    reserved_words_() {
-        RESERVE_WORD("main", TOK_MAIN);
-        RESERVE_WORD("let", TOK_LET);
-        RESERVE_WORD("call", TOK_CALL);
-        RESERVE_WORD("if", TOK_IF);
-        RESERVE_WORD("then", TOK_THEN);
-        RESERVE_WORD("else", TOK_ELSE);
-        RESERVE_WORD("fi", TOK_FI);
-        RESERVE_WORD("while", TOK_WHILE);
-        RESERVE_WORD("do", TOK_DO);
-        RESERVE_WORD("od", TOK_OD);
-        RESERVE_WORD("return", TOK_RETURN);
-        RESERVE_WORD("var", TOK_VAR);
-        RESERVE_WORD("array", TOK_ARRAY);
-        RESERVE_WORD("function", TOK_FUNCTION);
-        RESERVE_WORD("procedure", TOK_PROCEDURE);
+    current_symbol_(NO_SYMBOL) {
+        // Piped input cannot be mapped. It is read once and lexed from
+        // the copy.
+        input_begin_ = stream_contents_.data();
+        input_end_   = input_begin_ + stream_contents_.size();
+        cursor_      = input_begin_;
+}
+
+Lexer::Lexer(const std::string& file_name) :
+    mapping_(nullptr),
+    mapping_size_(0),
+    token_offset_(0),
+    token_length_(0),
+    current_lineno_(1),
+    current_token_(Lexer::TOK_NONE),
+    current_symbol_(NO_SYMBOL) {
+        MapFile(file_name);
+}
+
+Lexer::Lexer(const char* begin, const char* end, int line_no) :
+    mapping_(nullptr),
+    mapping_size_(0),
+    input_begin_(begin),
+    input_end_(end),
+    cursor_(begin),
+    token_offset_(0),
+    token_length_(0),
+    current_lineno_(line_no),
+    current_token_(Lexer::TOK_NONE),
+    current_symbol_(NO_SYMBOL) {}
+
+Lexer::~Lexer() {
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapping_size_);
+    }
 }
 
-void Lexer::Reserve(std::string& word, Lexer::Token& token) {
-    RESERVE_WORD(word, token);
+// Map the file read-only into memory. Tokens handed out by the Lexer are
+// views into this mapping, so it is kept alive until the Lexer is destroyed.
+void Lexer::MapFile(const std::string& file_name) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd == -1) {
+        LOG(ERROR) << "[LEXER] Could not open file: " << file_name;
+        exit(1);
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) == -1) {
+        LOG(ERROR) << "[LEXER] Could not stat file: " << file_name;
+        close(fd);
+        exit(1);
+    }
+
+    // mmap() does not accept empty mappings. An empty file is simply an
+    // empty range.
+    if (sb.st_size > 0) {
+        mapping_size_ = sb.st_size;
+        void* addr = mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            LOG(ERROR) << "[LEXER] Could not map file: " << file_name;
+            close(fd);
+            exit(1);
+        }
+
+        mapping_ = static_cast<char*>(addr);
+        madvise(mapping_, mapping_size_, MADV_SEQUENTIAL);
+    }
+
+    close(fd);
+
+    input_begin_ = mapping_ != nullptr ? mapping_ : stream_contents_.data();
+    input_end_   = input_begin_ + mapping_size_;
+    cursor_      = input_begin_;
 }
 //////////////////////////////
  
 //////////////////////////////
-char Lexer::ReadChar() {
-    last_char_ = ch_;
-    input_buffer_.get(ch_); 
-
-    if (input_buffer_.eof()) return EOF;
-    return ch_;
+char Lexer::PeekChar() const {
+    if (cursor_ == input_end_) return EOF;
+    return *cursor_;
 }
 
-char Lexer::PeekChar() {
-    if (input_buffer_.eof()) return EOF;
-
-    return input_buffer_.peek();
+char Lexer::PeekChar(std::size_t ahead) const {
+    if (ahead >= static_cast<std::size_t>(input_end_ - cursor_)) return EOF;
+    return cursor_[ahead];
 }
 
 void Lexer::ReadAndAdvance() {
-    current_buffer_.push_back(ReadChar());
+    AdvanceTo(cursor_ + 1);
 }
 
-void Lexer::ConsumeLine() {
-    char peek_char = PeekChar();
-    while (peek_char != EOF && peek_char != '\n') {
-        ReadChar();
-        peek_char= PeekChar();
-    }
+void Lexer::AdvanceTo(const char* position) {
+    cursor_ = position;
+    token_length_ = cursor_ - (input_begin_ + token_offset_);
 }
 
-Lexer::Token Lexer::ConsumeWhitespaceAndComments() {
-    char peek_char = PeekChar();
-    while (peek_char != EOF) {
-        if (peek_char == ' ' || peek_char == '\t' || peek_char == '\r') {
-            ReadChar();
-        } else if (peek_char == '\n') {
-            current_lineno_ += 1;
-            ReadChar();
-        } else if (peek_char == '#') {
-            ConsumeLine();
-        } else if (PeekChar() == '/') {
-            ReadChar();
-            if (PeekChar() == '/') {
-                ConsumeLine();
-            } else {
-                return TOK_BINOP_DIV;
-            }
+void Lexer::ConsumeWhitespaceAndComments() {
+    while (cursor_ != input_end_) {
+        cursor_ = SkipBlanks(cursor_, input_end_, current_lineno_);
+
+        char peek_char = PeekChar();
+        if (peek_char == '#' ||
+            (peek_char == '/' && PeekChar(1) == '/')) {
+            // The '\n' ending the comment is consumed along with the
+            // blanks in the next iteration.
+            cursor_ = FindNewline(cursor_, input_end_);
         } else {
             break;
         }
-
-        peek_char = PeekChar();
     }
+}
 
-    return TOK_NONE;
+void Lexer::Seek(const char* position, int line_no) {
+    cursor_         = position;
+    token_offset_   = cursor_ - input_begin_;
+    token_length_   = 0;
+    current_lineno_ = line_no;
+    current_token_  = TOK_NONE;
+    current_symbol_ = NO_SYMBOL;
 }
 
 Lexer::Token Lexer::GetNextToken() {
     if (current_token_ == TOK_EOF)
         return current_token_;
 
-    current_buffer_ = "";
     current_token_ = TOK_NONE;
+    current_symbol_ = NO_SYMBOL;
 
-    if (TOK_BINOP_DIV == ConsumeWhitespaceAndComments()) {
-        current_token_ = TOK_BINOP_DIV;
-        return current_token_;
-    }
+    ConsumeWhitespaceAndComments();
+
+    token_offset_ = cursor_ - input_begin_;
+    token_length_ = 0;
         
-    if (std::isalpha(PeekChar())) {
-        ReadAndAdvance();
-        while (std::isalnum(PeekChar())) {
-            ReadAndAdvance();
-        }
-        auto res_word_it = reserved_words_.find(current_buffer_);
-        if (res_word_it != reserved_words_.end()) {
-            // Found a Reserved word!
-            // Return token since we have already stored it.
-            current_token_ = res_word_it->second;
-        } else {
-            current_token_ = TOK_IDENT;
-        }
-    } else if (std::isdigit(PeekChar())) {
-        ReadAndAdvance();
-        while (std::isdigit(PeekChar())) {
-            ReadAndAdvance();
+    if (IsAlpha(PeekChar())) {
+        AdvanceTo(SkipAlnum(cursor_ + 1, input_end_));
+
+        // Either a Reserved word or an identifier
+        current_token_ = LookupKeyword(GetBuffer());
+        if (current_token_ == TOK_IDENT) {
+            current_symbol_ = Intern(GetBuffer());
         }
-        if (std::isalpha(PeekChar())) {
+    } else if (IsDigit(PeekChar())) {
+        AdvanceTo(SkipDigits(cursor_ + 1, input_end_));
+
+        if (IsAlpha(PeekChar())) {
             LOG(ERROR) << "[LEXER] Invalid number literal found on Line: " << current_lineno_;
         } else {
             current_token_ = TOK_NUM;
@@ -131,9 +245,9 @@ Lexer::Token Lexer::GetNextToken() {
                 ReadAndAdvance();
                 if (PeekChar() == '=') {
                     ReadAndAdvance();
-                    current_token_ = last_char_ == '!' ? TOK_RELOP_NEQ : TOK_RELOP_EQ;
+                    current_token_ = GetBuffer().front() == '!' ? TOK_RELOP_NEQ : TOK_RELOP_EQ;
                 } else {
-                    LOG(ERROR) << "[LEXER] Invalid character found after " << last_char_ << " on Line: " << current_lineno_;
+                    LOG(ERROR) << "[LEXER] Invalid character found after " << GetBuffer().front() << " on Line: " << current_lineno_;
                 }
                 break;
             case '<':
@@ -146,7 +260,6 @@ Lexer::Token Lexer::GetNextToken() {
                         ReadAndAdvance();
                         current_token_ = TOK_RELOP_LTE;
                     } else {
-                        ReadAndAdvance();
                         current_token_ = TOK_RELOP_LT;
                     }
                 }
@@ -157,7 +270,6 @@ Lexer::Token Lexer::GetNextToken() {
                     ReadAndAdvance();
                     current_token_ = TOK_RELOP_GTE;
                 } else {
-                    ReadAndAdvance();
                     current_token_ = TOK_RELOP_GT;
                 }
                 break;
@@ -3,9 +3,11 @@
 
 #include "Papyrus/Logger/Logger.h"
 #include "Operation.h"
+#include "Interner.h"
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace papyrus {
@@ -68,19 +70,41 @@ public:
 
     //////////////////////////////
     Lexer(std::istream &i_buf);
+    Lexer(const std::string& file_name);
+    // Lexes [begin, end) of an input owned by someone else (usually another
+    // Lexer), starting at line line_no. The input must outlive the Lexer.
+    Lexer(const char* begin, const char* end, int line_no);
+    ~Lexer();
+
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
     //////////////////////////////
 
     //////////////////////////////
     Token GetNextToken();
+    // Continue lexing from position, the start of a token on line line_no
+    void Seek(const char* position, int line_no);
     //////////////////////////////
 
     //////////////////////////////
-    const std::string& GetBuffer() const { 
-        return current_buffer_;
+    // The buffer is a view into the input and stays valid for as long as
+    // the Lexer is alive.
+    std::string_view GetBuffer() const { 
+        return std::string_view(input_begin_ + token_offset_, token_length_);
+    }
+    std::size_t GetOffset() const {
+        return token_offset_;
+    }
+    const char* InputEnd() const {
+        return input_end_;
     }
     Token GetToken() const { 
         return current_token_;
     }
+    // Interned identifier for TOK_IDENT, NO_SYMBOL otherwise
+    SymbolId GetSymbol() const {
+        return current_symbol_;
+    }
     int GetLineNo() const { 
         return current_lineno_;
     }
@@ -102,29 +126,36 @@ private:
     //////////////////////////////
     // Private variables
     //
-    // Most things here are self-explanatory.
+    // The whole input is available as one contiguous range
+    // [input_begin_, input_end_). For files, this is a read-only mapping
+    // of the file. For streams (piped input), the stream is read once into
+    // stream_contents_. Tokens are (offset, length) pairs into this range;
+    // no characters are copied while lexing.
     //////////////////////////////
-    std::istream& input_buffer_;
-    std::string current_buffer_;
+    std::string stream_contents_;
+    char* mapping_;
+    std::size_t mapping_size_;
+
+    const char* input_begin_;
+    const char* input_end_;
+    const char* cursor_;
+
+    std::size_t token_offset_;
+    std::size_t token_length_;
+
     int current_lineno_;
-    char ch_;
-    char last_char_;
     Token current_token_;
-
-    //////////////////////////////
-    // Map for Reserved words in the language
-    //////////////////////////////
-    std::unordered_map<std::string, Token> reserved_words_;
+    SymbolId current_symbol_;
 
     //////////////////////////////
     // Methods
     //////////////////////////////
-    char ReadChar();
-    char PeekChar();
+    char PeekChar() const;
+    char PeekChar(std::size_t) const;
     void ReadAndAdvance();
-    void ConsumeLine();
-    Lexer::Token ConsumeWhitespaceAndComments();
-    inline void Reserve(std::string&, Token&);
+    void AdvanceTo(const char*);
+    void MapFile(const std::string&);
+    void ConsumeWhitespaceAndComments();
 
     //////////////////////////////
     std::unordered_map<Token, std::string> token_translations_ {
@@ -0,0 +1,165 @@
+#ifndef PAPYRUS_NODEPOOL_H
+#define PAPYRUS_NODEPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace papyrus {
+
+/*
+ * Storage for the AST. Nodes of one type live contiguously in a NodePool and
+ * refer to each other through 32-bit NodeRefs instead of pointers. Lists of
+ * children are stored as contiguous ranges of a ListPool.
+ *
+ * Pools only ever grow while parsing, so NodeRefs stay valid but references
+ * into a pool do not: a node must not be held by reference across the
+ * creation of another node of the same type.
+ */
+
+constexpr uint32_t NO_NODE = UINT32_MAX;
+
+template <typename T>
+class NodeRef {
+public:
+    NodeRef() : index_(NO_NODE) {}
+    explicit NodeRef(uint32_t index) : index_(index) {}
+
+    uint32_t Index() const { return index_; }
+    bool IsValid() const { return index_ != NO_NODE; }
+
+private:
+    uint32_t index_;
+};
+
+// Moves ref by the given number of nodes, used when appending one pool to
+// another. Invalid refs stay invalid.
+template <typename T>
+NodeRef<T> Shift(NodeRef<T> ref, uint32_t by) {
+    return ref.IsValid() ? NodeRef<T>(ref.Index() + by) : ref;
+}
+
+template <typename T>
+class NodePool {
+public:
+    NodeRef<T> Add(const T& node) {
+        nodes_.push_back(node);
+        return NodeRef<T>(static_cast<uint32_t>(nodes_.size() - 1));
+    }
+
+    const T& operator[](NodeRef<T> ref) const { return nodes_[ref.Index()]; }
+
+    typename std::vector<T>::const_iterator begin() const { return nodes_.cbegin(); }
+    typename std::vector<T>::const_iterator end() const { return nodes_.cend(); }
+
+    std::size_t Size() const { return nodes_.size(); }
+    std::size_t BytesAllocated() const { return nodes_.capacity() * sizeof(T); }
+
+    // Adds rebase(node) for every node of other, in order
+    template <typename F>
+    void Append(const NodePool& other, F rebase) {
+        nodes_.reserve(nodes_.size() + other.nodes_.size());
+        for (auto& node: other.nodes_) {
+            nodes_.push_back(rebase(node));
+        }
+    }
+
+    // Drops the nodes but keeps the storage for reuse
+    void Clear() { nodes_.clear(); }
+
+private:
+    std::vector<T> nodes_;
+};
+
+// A list of children, elements [first, first + count) of a ListPool
+struct ListRange {
+    uint32_t first = 0;
+    uint32_t count = 0;
+};
+
+inline ListRange Shift(ListRange range, uint32_t by) {
+    range.first += by;
+    return range;
+}
+
+template <typename E>
+class ListView {
+public:
+    using const_reverse_iterator = std::reverse_iterator<const E*>;
+
+    ListView(const E* first, const E* last) : first_(first), last_(last) {}
+
+    const E* begin() const { return first_; }
+    const E* end() const { return last_; }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(last_); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(first_); }
+
+    std::size_t size() const { return last_ - first_; }
+    bool empty() const { return first_ == last_; }
+    const E& operator[](std::size_t idx) const { return first_[idx]; }
+
+private:
+    const E* first_;
+    const E* last_;
+};
+
+/*
+ * Lists are built on a scratch stack while their elements are being parsed
+ * and are copied into the pool in one go once complete, which keeps each
+ * list contiguous even though parsing an element may build other lists:
+ *
+ *     auto mark = pool.Open();
+ *     pool.Push(...);             // repeated, may nest Open()/Close()
+ *     ListRange r = pool.Close(mark);
+ */
+template <typename E>
+class ListPool {
+public:
+    std::size_t Open() const { return scratch_.size(); }
+    void Push(const E& elem) { scratch_.push_back(elem); }
+
+    ListRange Close(std::size_t mark) {
+        ListRange range;
+        range.first = static_cast<uint32_t>(elems_.size());
+        range.count = static_cast<uint32_t>(scratch_.size() - mark);
+
+        elems_.insert(elems_.end(), scratch_.begin() + mark, scratch_.end());
+        scratch_.erase(scratch_.begin() + mark, scratch_.end());
+
+        return range;
+    }
+
+    std::size_t Size() const { return elems_.size(); }
+
+    // Adds rebase(elem) for every element of other's complete lists, in order
+    template <typename F>
+    void Append(const ListPool& other, F rebase) {
+        elems_.reserve(elems_.size() + other.elems_.size());
+        for (auto& elem: other.elems_) {
+            elems_.push_back(rebase(elem));
+        }
+    }
+
+    ListView<E> View(ListRange range) const {
+        const E* first = elems_.data() + range.first;
+        return ListView<E>(first, first + range.count);
+    }
+
+    std::size_t BytesAllocated() const {
+        return (elems_.capacity() + scratch_.capacity()) * sizeof(E);
+    }
+
+    void Clear() {
+        elems_.clear();
+        scratch_.clear();
+    }
+
+private:
+    std::vector<E> elems_;
+    std::vector<E> scratch_;
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_NODEPOOL_H */
@@ -0,0 +1,175 @@
+#ifndef PAPYRUS_FRONTEND_SCAN_H
+#define PAPYRUS_FRONTEND_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace papyrus {
+
+/*
+ * Character-class scanning used by the Lexer. Each Skip* function returns a
+ * pointer to the first character in [p, end) which does not belong to the
+ * class. Where available, 32 (AVX2) or 16 (SSE2) bytes are classified at a
+ * time; the tail of the input and other targets use the scalar loops.
+ *
+ * Loads never cross `end`, so the input does not need any padding. This
+ * matters for memory-mapped input which ends exactly at the end of the file.
+ */
+
+inline bool IsBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline bool IsAlpha(char c) {
+    return static_cast<unsigned char>((c | 0x20) - 'a') < 26;
+}
+
+inline bool IsDigit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline bool IsAlnum(char c) {
+    return IsAlpha(c) || IsDigit(c);
+}
+
+namespace scan {
+
+#if defined(__AVX2__)
+struct Block {
+    using Vec = __m256i;
+    static constexpr std::size_t kWidth = 32;
+
+    static Vec Load(const char* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const Vec*>(p));
+    }
+    static Vec Eq(Vec v, char c) {
+        return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c));
+    }
+    // Signed compares are fine here: all ranges are ASCII, and bytes >= 0x80
+    // are negative and hence never part of a range.
+    static Vec Range(Vec v, char lo, char hi) {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)),
+                                _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+    }
+    static Vec Or(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+    static Vec Lower(Vec v) { return _mm256_or_si256(v, _mm256_set1_epi8(0x20)); }
+    static uint32_t Mask(Vec v) { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+};
+#elif defined(__SSE2__)
+struct Block {
+    using Vec = __m128i;
+    static constexpr std::size_t kWidth = 16;
+
+    static Vec Load(const char* p) {
+        return _mm_loadu_si128(reinterpret_cast<const Vec*>(p));
+    }
+    static Vec Eq(Vec v, char c) {
+        return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+    }
+    static Vec Range(Vec v, char lo, char hi) {
+        return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)),
+                             _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), v));
+    }
+    static Vec Or(Vec a, Vec b) { return _mm_or_si128(a, b); }
+    static Vec Lower(Vec v) { return _mm_or_si128(v, _mm_set1_epi8(0x20)); }
+    static uint32_t Mask(Vec v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+};
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+constexpr uint32_t kFullMask = Block::kWidth == 32 ? 0xFFFFFFFFu : 0xFFFFu;
+
+inline Block::Vec AlnumMask(Block::Vec v) {
+    return Block::Or(Block::Range(Block::Lower(v), 'a', 'z'),
+                     Block::Range(v, '0', '9'));
+}
+#endif
+
+} // namespace scan
+
+inline const char* SkipAlnum(const char* p, const char* end) {
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (static_cast<std::size_t>(end - p) >= scan::Block::kWidth) {
+        uint32_t outside = ~scan::Block::Mask(scan::AlnumMask(scan::Block::Load(p))) & scan::kFullMask;
+        if (outside != 0) {
+            return p + __builtin_ctz(outside);
+        }
+        p += scan::Block::kWidth;
+    }
+#endif
+    while (p != end && IsAlnum(*p)) {
+        p++;
+    }
+    return p;
+}
+
+inline const char* SkipDigits(const char* p, const char* end) {
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (static_cast<std::size_t>(end - p) >= scan::Block::kWidth) {
+        auto v = scan::Block::Load(p);
+        uint32_t outside = ~scan::Block::Mask(scan::Block::Range(v, '0', '9')) & scan::kFullMask;
+        if (outside != 0) {
+            return p + __builtin_ctz(outside);
+        }
+        p += scan::Block::kWidth;
+    }
+#endif
+    while (p != end && IsDigit(*p)) {
+        p++;
+    }
+    return p;
+}
+
+// Skips spaces, tabs and line breaks. The number of '\n' characters skipped
+// is added to `newlines`.
+inline const char* SkipBlanks(const char* p, const char* end, int& newlines) {
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (static_cast<std::size_t>(end - p) >= scan::Block::kWidth) {
+        auto v = scan::Block::Load(p);
+        uint32_t nl = scan::Block::Mask(scan::Block::Eq(v, '\n'));
+        uint32_t blank = nl | scan::Block::Mask(scan::Block::Or(
+                                  scan::Block::Or(scan::Block::Eq(v, ' '), scan::Block::Eq(v, '\t')),
+                                  scan::Block::Eq(v, '\r')));
+        uint32_t outside = ~blank & scan::kFullMask;
+        if (outside != 0) {
+            int pos = __builtin_ctz(outside);
+            newlines += __builtin_popcount(nl & ((1u << pos) - 1));
+            return p + pos;
+        }
+        newlines += __builtin_popcount(nl);
+        p += scan::Block::kWidth;
+    }
+#endif
+    while (p != end && IsBlank(*p)) {
+        if (*p == '\n') {
+            newlines++;
+        }
+        p++;
+    }
+    return p;
+}
+
+// Returns a pointer to the next '\n' (or `end`). Used to skip comments.
+inline const char* FindNewline(const char* p, const char* end) {
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (static_cast<std::size_t>(end - p) >= scan::Block::kWidth) {
+        uint32_t nl = scan::Block::Mask(scan::Block::Eq(scan::Block::Load(p), '\n'));
+        if (nl != 0) {
+            return p + __builtin_ctz(nl);
+        }
+        p += scan::Block::kWidth;
+    }
+#endif
+    while (p != end && *p != '\n') {
+        p++;
+    }
+    return p;
+}
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_FRONTEND_SCAN_H */
@@ -0,0 +1,34 @@
+#include "SymbolTable.h"
+
+using namespace papyrus;
+
+// Later declarations overwrite earlier ones in the index
+void SymbolTable::Declare(SymbolId identifier, Symbol* sym) {
+    index_[identifier] = entries_.size();
+    entries_.push_back(std::make_pair(identifier, sym));
+}
+
+Symbol* SymbolTable::LookupLocal(SymbolId identifier) const {
+    auto it = index_.find(identifier);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+
+    return entries_[it->second].second;
+}
+
+Symbol* SymbolTable::Lookup(SymbolId identifier) const {
+    for (auto scope = this; scope != nullptr; scope = scope->parent_) {
+        Symbol* sym = scope->LookupLocal(identifier);
+        if (sym != nullptr) {
+            return sym;
+        }
+    }
+
+    return nullptr;
+}
+
+void SymbolTable::clear() {
+    entries_.clear();
+    index_.clear();
+}
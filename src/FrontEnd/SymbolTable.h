@@ -0,0 +1,61 @@
+#ifndef PAPYRUS_SYMBOLTABLE_H
+#define PAPYRUS_SYMBOLTABLE_H
+
+#include "Interner.h"
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace papyrus {
+
+class Symbol;
+
+/*
+ * SymbolTable holds the symbols declared in one scope (the globals, or the
+ * formals and locals of a function). Lookups are hashed, while iteration
+ * yields the symbols in declaration order since the stack and global offsets
+ * are assigned in that order.
+ *
+ * A scope may have an enclosing scope, which Lookup() falls back to. Function
+ * scopes are enclosed by the global scope.
+ *
+ * The hash index is kept up to date by Declare(), so lookups do not modify
+ * the table. Function scopes parsed in parallel look up the global scope
+ * from several threads at once.
+ */
+class SymbolTable {
+public:
+    using Entry = std::pair<SymbolId, Symbol*>;
+    using const_iterator = std::vector<Entry>::const_iterator;
+
+    SymbolTable(const SymbolTable* parent = nullptr) : parent_(parent) {}
+
+    // A symbol declared twice in the same scope is kept twice, in order. The
+    // later declaration is the one which is looked up.
+    void Declare(SymbolId, Symbol*);
+
+    // Only this scope
+    Symbol* LookupLocal(SymbolId) const;
+    // This scope, then the enclosing ones
+    Symbol* Lookup(SymbolId) const;
+
+    const_iterator begin() const { return entries_.cbegin(); }
+    const_iterator end() const { return entries_.cend(); }
+    std::size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    void clear();
+
+private:
+    const SymbolTable* parent_;
+
+    std::vector<Entry> entries_;
+    // SymbolId -> position in entries_
+    std::unordered_map<SymbolId, std::size_t> index_;
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_SYMBOLTABLE_H */
@@ -0,0 +1,98 @@
+#ifndef PAPYRUS_TOKENBUFFER_H
+#define PAPYRUS_TOKENBUFFER_H
+
+#include "Lexer.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace papyrus {
+
+/*
+ * TokenBuffer sits between the Lexer and the parser and provides the current
+ * token along with up to LOOKAHEAD tokens after it. Tokens are kept in a
+ * fixed-size ring of TokenRecords, each holding everything the parser needs
+ * to know about a token. The text of a token is a view into the input of the
+ * Lexer, so no characters are copied.
+ *
+ * The current token starts out as TOK_NONE; the first Advance() makes the
+ * first token of the input current.
+ */
+struct TokenRecord {
+    Lexer::Token kind;
+    std::string_view span;
+    int line_no;
+    // Interned identifier for TOK_IDENT, NO_SYMBOL otherwise
+    SymbolId symbol;
+};
+
+class TokenBuffer {
+public:
+    // Number of tokens which can be looked at past the current one
+    static constexpr std::size_t LOOKAHEAD = 3;
+
+    TokenBuffer(Lexer& lexer) : lexer_(lexer) {
+        Reset();
+    }
+
+    // Drops the buffered tokens, e.g. after the Lexer has been moved with
+    // Seek(). The next Advance() makes the next token of the Lexer current.
+    void Reset() {
+        head_  = 0;
+        count_ = 1;
+        ring_[0] = {Lexer::TOK_NONE, std::string_view(), lexer_.GetLineNo(), NO_SYMBOL};
+    }
+
+    const TokenRecord& Current() const { return ring_[head_]; }
+
+    // The k-th token after the current one, 1 <= k <= LOOKAHEAD
+    const TokenRecord& Peek(std::size_t k = 1) {
+        // Further ahead, the ring would wrap around onto the current token
+        assert(k >= 1 && k <= LOOKAHEAD);
+        while (count_ <= k) {
+            Fill();
+        }
+        return ring_[(head_ + k) & MASK];
+    }
+
+    // Makes the next token current
+    void Advance() {
+        if (count_ == 1) {
+            Fill();
+        }
+        head_ = (head_ + 1) & MASK;
+        count_--;
+    }
+
+private:
+    static constexpr std::size_t SIZE = 4;
+    static constexpr std::size_t MASK = SIZE - 1;
+    static_assert((SIZE & MASK) == 0, "TokenBuffer size must be a power of two");
+    static_assert(LOOKAHEAD < SIZE, "TokenBuffer is too small for its lookahead");
+
+    Lexer& lexer_;
+    TokenRecord ring_[SIZE];
+
+    // The current token is ring_[head_], followed by count_ - 1 tokens
+    // which have been lexed but not consumed yet.
+    std::size_t head_;
+    std::size_t count_;
+
+    void Fill() {
+        Lexer::Token kind = lexer_.GetNextToken();
+
+        TokenRecord& record = ring_[(head_ + count_) & MASK];
+        record.kind    = kind;
+        record.span    = lexer_.GetBuffer();
+        record.line_no = lexer_.GetLineNo();
+        record.symbol  = lexer_.GetSymbol();
+
+        count_++;
+    }
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_TOKENBUFFER_H */
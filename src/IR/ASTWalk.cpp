@@ -10,41 +10,30 @@ using namespace papyrus;
 #define REDUCIBLE -2
 
 /*
- * ConstantNode is converted into Value with VAL_CONST and the value of the
- * number embedded in it
- */
-VI ConstantNode::GenerateIR(IRC& irc) const {
-    LOG(INFO) << "Parsing constant";
-
-    return CC(value_);
-}
-
-/*
- * FactorNode is converted into a Value as well
+ * FactorNode is converted into a Value. Numbers are converted into a Value
+ * with VAL_CONST and the value of the number embedded in it
  */
 VI FactorNode::GenerateIR(IRC& irc) const {
     LOG(INFO) << "Parsing factor";
 
+    const ASTPool& ast = irc.ASTConst().Nodes();
+
     VI result = NOTFOUND;
     switch(factor_type_) {
         case FACT_DESIGNATOR: {
-            auto design = static_cast<const DesignatorNode*>(factor_node_);
-            result = design->GenerateIR(irc);
+            result = ast.designators[NodeRef<DesignatorNode>(index_)].GenerateIR(irc);
             break;
         }
         case FACT_NUMBER: {
-            auto cnstn = static_cast<const ConstantNode*>(factor_node_);
-            result = cnstn->GenerateIR(irc);
+            result = CC(value_);
             break;
         }
         case FACT_EXPR: {
-            auto exprn = static_cast<const ExpressionNode*>(factor_node_);
-            result = exprn->GenerateIR(irc);
+            result = ast.expressions[NodeRef<ExpressionNode>(index_)].GenerateIR(irc);
             break;
         }
         case FACT_FUNCCALL: {
-            auto fncn = static_cast<const FunctionCallNode*>(factor_node_);
-            result = fncn->GenerateIR(irc);
+            result = ast.calls[NodeRef<FunctionCallNode>(index_)].GenerateIR(irc);
             break;
         }
     }
@@ -52,6 +41,22 @@ VI FactorNode::GenerateIR(IRC& irc) const {
     return result;
 }
 
+/*
+ * Emits (idx_1 op idx_2), folding it if both are constants
+ */
+VI papyrus::EmitArithmetic(IRC& irc, ArithmeticOperator op, VI idx_1, VI idx_2) {
+    // Check if factor is reducible
+    // If yes, fold it.
+    auto temp = CF->TryReduce(op, idx_1, idx_2);
+    if (temp == NOTFOUND) {
+        //////////////////////////////////////////////////
+        return MI(irc.ConvertOperation(op), idx_1, idx_2);
+        //////////////////////////////////////////////////
+    }
+
+    return temp;
+}
+
 /* 
  * Convert TermNode into a Value
  */
@@ -62,27 +67,20 @@ VI TermNode::GenerateIR(IRC& irc) const {
     // For each of the (other) secondary factors, convert them to a value
     // and then FACTOR_1 (op) FACTOR_2
     // and so on..
+    const ASTPool& ast = irc.ASTConst().Nodes();
+
     VI idx_1, idx_2;
-    idx_1 = primary_factor_->GenerateIR(irc);
+    idx_1 = ast.factors[primary_factor_].GenerateIR(irc);
 
     ArithmeticOperator op;
-    const FactorNode* fact;
-    for (auto next_pair: secondary_factors_) {
+    NodeRef<FactorNode> fact;
+    for (auto next_pair: ast.factor_lists.View(secondary_factors_)) {
         op    = next_pair.first;
         fact  = next_pair.second;
 
-        idx_2 = fact->GenerateIR(irc);
+        idx_2 = ast.factors[fact].GenerateIR(irc);
 
-        // Check if factor is reducible
-        // If yes, fold it.
-        auto temp = CF->TryReduce(op, idx_1, idx_2);
-        if (temp == NOTFOUND) {
-            //////////////////////////////////////////////////
-            idx_1 = MI(irc.ConvertOperation(op), idx_1, idx_2);
-            //////////////////////////////////////////////////
-        } else {
-            idx_1 = temp;
-        }
+        idx_1 = EmitArithmetic(irc, op, idx_1, idx_2);
     }
 
     return idx_1;
@@ -98,27 +96,20 @@ VI ExpressionNode::GenerateIR(IRC& irc) const {
     // For each of the (other) secondary terms, convert them to a value
     // and then TERM_1 (op) TERM_2
     // and so on..
+    const ASTPool& ast = irc.ASTConst().Nodes();
+
     VI idx_1, idx_2;
-    idx_1 = primary_term_->GenerateIR(irc);
+    idx_1 = ast.terms[primary_term_].GenerateIR(irc);
 
     ArithmeticOperator op;
-    const TermNode* term;
-    for (auto next_pair: secondary_terms_) {
+    NodeRef<TermNode> term;
+    for (auto next_pair: ast.term_lists.View(secondary_terms_)) {
         op    = next_pair.first;
         term  = next_pair.second;
 
-        idx_2 = term->GenerateIR(irc);
+        idx_2 = ast.terms[term].GenerateIR(irc);
 
-        // Check if factor is reducible
-        // If yes, fold it.
-        auto temp = CF->TryReduce(op, idx_1, idx_2);
-        if (temp == NOTFOUND) {
-            //////////////////////////////////////////////////
-            idx_1 = MI(irc.ConvertOperation(op), idx_1, idx_2);
-            //////////////////////////////////////////////////
-        } else {
-            idx_1 = temp;
-        }
+        idx_1 = EmitArithmetic(irc, op, idx_1, idx_2);
     }
 
     return idx_1;
@@ -128,10 +119,13 @@ VI ExpressionNode::GenerateIR(IRC& irc) const {
  * For arrays, we do not perform any kind of optimizations. Ideally, we should
  * take care optimizing base value calculations and only change the index
  */
-VI ArrIdentifierNode::GenerateIR(IRC& irc) const {
+VI DesignatorNode::GenerateAddressIR(IRC& irc) const {
     LOG(INFO) << "Parsing ArrIdentifier";
 
-    auto var_name = IdentifierName();
+    const ASTPool& ast = irc.ASTConst().Nodes();
+    auto indirections = ast.expression_lists.View(indirections_);
+
+    auto var_name = GetSymbol();
     VI base, offset, temp;
 
     const Variable* var;
@@ -154,16 +148,16 @@ VI ArrIdentifierNode::GenerateIR(IRC& irc) const {
         //
         // offset = CC(irc.GlobalOffset(var_name)*4);
     } else {
-        LOG(ERROR) << "[IR] Usage of variable " + var_name + " which is not defined.";
+        LOG(ERROR) << "[IR] Usage of variable " + SymbolName(var_name) + " which is not defined.";
         exit(1);
     }
 
     // Basic error checking - Check if variables are being used correctly
     if (!var->IsArray()) {
-        LOG(ERROR) << "[IR] Usage of variable " + var_name + " as an array.";
+        LOG(ERROR) << "[IR] Usage of variable " + SymbolName(var_name) + " as an array.";
         exit(1);
-    } else if (indirections_.size() != var->GetDimensions().size()) {
-        LOG(ERROR) << "[IR] Incorrect indirections given to " + var_name + " in usage";
+    } else if (indirections.size() != var->GetDimensions().size()) {
+        LOG(ERROR) << "[IR] Incorrect indirections given to " + SymbolName(var_name) + " in usage";
         exit(1);
     }
 
@@ -175,12 +169,11 @@ VI ArrIdentifierNode::GenerateIR(IRC& irc) const {
     VI arr_base = MI(T::INS_ADD, offset, base);
     //////////////////////////////////////////////////
 
-    auto ind_temp(indirections_);
-    std::reverse(ind_temp.begin(), ind_temp.end());
-    auto it = ind_temp.begin();
+    // Indirections are generated innermost first
+    auto it = indirections.rbegin();
 
     auto expr  = *it;
-    VI offset_idx = expr->GenerateIR(irc);
+    VI offset_idx = ast.expressions[expr].GenerateIR(irc);
     it++;
     VI temp_idx;
 
@@ -211,14 +204,14 @@ VI ArrIdentifierNode::GenerateIR(IRC& irc) const {
     std::reverse(var_temp.begin(), var_temp.end());
     auto dim_it = var_temp.begin();
 
-    while (it != ind_temp.end()) {
+    while (it != indirections.rend()) {
         dim_offset *= *dim_it;
         // Changed it back again
         dim_idx     = CC(dim_offset);
 
         expr = *it;
 
-        auto expr_idx = expr->GenerateIR(irc);
+        auto expr_idx = ast.expressions[expr].GenerateIR(irc);
 
         // Add to access_str
         // if (CF->GetValue(expr_idx)->Type() == V::VAL_CONST) {
@@ -278,15 +271,11 @@ VI ArrIdentifierNode::GenerateIR(IRC& irc) const {
 
     return result;
 }
-
 /*
- * Depending on the type of the variable local v/s global generate a Value
+ * Read of a scalar variable used in an expression
  */
-VI DesignatorNode::GenerateIR(IRC& irc) const {
-    LOG(INFO) << "[IR] Parsing designator";
-
+VI papyrus::EmitVariableRead(IRC& irc, SymbolId var_name) {
     VI result = NOTFOUND;
-    auto var_name = identifier_->IdentifierName();
 
     const Variable* var;
     
@@ -296,103 +285,117 @@ VI DesignatorNode::GenerateIR(IRC& irc) const {
     } else if (irc.IsVariableGlobal(var_name)) {
         var = irc.GetGlobal(var_name);
     } else {
-        LOG(ERROR) << "[IR] Usage of variable " + var_name + " which is not defined.";
+        LOG(ERROR) << "[IR] Usage of variable " + SymbolName(var_name) + " which is not defined.";
         exit(1);
     }
     
     // Check if being used correctly
-    if (var->IsArray() && desig_type_ == DESIG_VAR) {
-        LOG(ERROR) << "[IR] Usage of variable " + var_name + " as a variable which is an array";
+    if (var->IsArray()) {
+        LOG(ERROR) << "[IR] Usage of variable " + SymbolName(var_name) + " as a variable which is an array";
         exit(1);
     }
 
-    if (desig_type_ == DESIG_VAR) {
-        if (CF->IsVariableLocal(var_name)) {
-            // Handling formals:
-            //
-            // The way we handle formals right now is that we assume them to be
-            // local variables. But their first load is from the stack since the
-            // assumption is that they are passed to functions from the stack.
-            // Once they are loaded, they are marked loaded. In the register 
-            // allocation phase, we can then choose to store/reload them as
-            // necessary. We create an instruction which will create a memory
-            // location value on the stack; localbase - (4 * ParamNumber). This
-            // is an approximation as there will be the return address on the
-            // stack as well. But that is part of the ABI which can be modified
-            // according to the architecture itself.
-            if (CF->IsVariableFormal(var_name) &&
-                !CF->IsFormalLoaded(var_name)) {
-
-                auto mem_location = var->GetLocationIdx();
-                //////////////////////////////////////////
-                auto temp = MI(T::INS_ADD, CF->LocalBase(), mem_location);
-                result    = MI(T::INS_LOAD, temp);
-                //////////////////////////////////////////
-
-                CF->LoadFormal(var_name);
-                CF->WriteVariable(var_name, result);
-            } else {
-                // Load variable. Can be thought of as a "SSA Read"
-                //
-                // This is the fundamental "read" of the SSA generation algorithm.
-                // For each variable, we go searching for the current definition
-                // of the variable. We start with the current block and then
-                // the predecessors and so on (lazily adding Phis wherever) we go
-                result = CF->ReadVariable(var_name, CF->CurrentBBIdx());
-            }
-        } else if (irc.IsVariableGlobal(var_name)) {
-            // This still uses *4 as we know that the offset is a constant
-            // calculated at compile time
-            // auto offset = irc.GlobalOffset(var_name);
-            // auto offset_idx = CC(offset*4);
-            auto offset_idx = var->GetLocationIdx();
-
-            /////////////////////////////////////
-            // Changed to use ADD instead of ADDA
-            auto mem_location = MI(T::INS_ADD, irc.GlobalBase(), offset_idx);
-            /////////////////////////////////////
-
-            CF->GetValue(mem_location)->SetIdentifier(var_name);
-            ////////////////////////////////////////
-            result = MI(T::INS_LOAD, mem_location);
-            ////////////////////////////////////////
+    if (CF->IsVariableLocal(var_name)) {
+        // Handling formals:
+        //
+        // The way we handle formals right now is that we assume them to be
+        // local variables. But their first load is from the stack since the
+        // assumption is that they are passed to functions from the stack.
+        // Once they are loaded, they are marked loaded. In the register 
+        // allocation phase, we can then choose to store/reload them as
+        // necessary. We create an instruction which will create a memory
+        // location value on the stack; localbase - (4 * ParamNumber). This
+        // is an approximation as there will be the return address on the
+        // stack as well. But that is part of the ABI which can be modified
+        // according to the architecture itself.
+        if (CF->IsVariableFormal(var_name) &&
+            !CF->IsFormalLoaded(var_name)) {
+
+            auto mem_location = var->GetLocationIdx();
+            //////////////////////////////////////////
+            auto temp = MI(T::INS_ADD, CF->LocalBase(), mem_location);
+            result    = MI(T::INS_LOAD, temp);
+            //////////////////////////////////////////
+
+            CF->LoadFormal(var_name);
+            CF->WriteVariable(var_name, result);
         } else {
-            LOG(ERROR) << "[IR] Usage of variable " + var_name + " which is not defined";
-            exit(1);
+            // Load variable. Can be thought of as a "SSA Read"
+            //
+            // This is the fundamental "read" of the SSA generation algorithm.
+            // For each variable, we go searching for the current definition
+            // of the variable. We start with the current block and then
+            // the predecessors and so on (lazily adding Phis wherever) we go
+            result = CF->ReadVariable(var_name, CF->CurrentBBIdx());
         }
     } else {
-        auto arr_id = static_cast<const ArrIdentifierNode*>(this);
-        auto mem_location = arr_id->GenerateIR(irc);
+        // This still uses *4 as we know that the offset is a constant
+        // calculated at compile time
+        // auto offset = irc.GlobalOffset(var_name);
+        // auto offset_idx = CC(offset*4);
+        auto offset_idx = var->GetLocationIdx();
 
-        CF->GetValue(mem_location)->SetIdentifier(var_name);
         /////////////////////////////////////
-        result = MI(T::INS_LOAD, mem_location);
+        // Changed to use ADD instead of ADDA
+        auto mem_location = MI(T::INS_ADD, irc.GlobalBase(), offset_idx);
         /////////////////////////////////////
-        
-        // All of the below instructions are used for collecting some extra
-        // information for optimizing away the loads and stores in the IR.
-        //
-        // Collecting some metadata for ArrayLSRemover
-        //
-        for (auto ins_idx: CF->CurrentLoadContributors()) {
-            CF->AddArrContributor(ins_idx, CF->CurrentInstructionIdx());
-        }
 
-        CF->ClearLoadContributor();
+        CF->GetValue(mem_location)->SetIdentifier(var_name);
+        ////////////////////////////////////////
+        result = MI(T::INS_LOAD, mem_location);
+        ////////////////////////////////////////
     }
 
     return result;
 }
 
-VI AssignmentNode::GenerateIR(IRC& irc) const {
-    LOG(INFO) << "[IR] Parsing assignment";
+/*
+ * Read of an array element used in an expression
+ */
+VI papyrus::EmitArrayRead(IRC& irc, const DesignatorNode* arr_id) {
+    auto var_name = arr_id->GetSymbol();
+    auto mem_location = arr_id->GenerateAddressIR(irc);
+
+    CF->GetValue(mem_location)->SetIdentifier(var_name);
+    /////////////////////////////////////
+    VI result = MI(T::INS_LOAD, mem_location);
+    /////////////////////////////////////
     
-    auto result = NOTFOUND;
+    // All of the below instructions are used for collecting some extra
+    // information for optimizing away the loads and stores in the IR.
+    //
+    // Collecting some metadata for ArrayLSRemover
+    //
+    for (auto ins_idx: CF->CurrentLoadContributors()) {
+        CF->AddArrContributor(ins_idx, CF->CurrentInstructionIdx());
+    }
 
-    auto expr_idx  = value_->GenerateIR(irc);
-    auto var_name  = designator_->IdentifierName();
+    CF->ClearLoadContributor();
 
-    if (designator_->GetDesignatorType() == DESIG_VAR) {
+    return result;
+}
+
+/*
+ * Depending on the type of the variable local v/s global generate a Value
+ */
+VI DesignatorNode::GenerateIR(IRC& irc) const {
+    LOG(INFO) << "[IR] Parsing designator";
+
+    if (desig_type_ == DESIG_VAR) {
+        return EmitVariableRead(irc, GetSymbol());
+    } else {
+        return EmitArrayRead(irc, this);
+    }
+}
+
+/*
+ * Stores expr_idx into var_name, or into the element of the array accessed
+ * through arr_id when it is not null
+ */
+VI papyrus::EmitAssignment(IRC& irc, SymbolId var_name, const DesignatorNode* arr_id, VI expr_idx) {
+    auto result = NOTFOUND;
+
+    if (arr_id == nullptr) {
         if (CF->IsVariableLocal(var_name)) {
             // If this is a formal param, we want to mark it loaded
             // since the next use should use this value and not load
@@ -446,14 +449,13 @@ VI AssignmentNode::GenerateIR(IRC& irc) const {
             result = MI(T::INS_STORE, expr_idx, mem_location);
             //////////////////////////////////////////////////
         } else {
-            LOG(ERROR) << "Usage of variable " + var_name + " which is not defined.";
+            LOG(ERROR) << "Usage of variable " + SymbolName(var_name) + " which is not defined.";
             exit(1);
         }
     } else {
        // Reset load contributors since they will be computed again.
        CF->ClearLoadContributor();
-       auto arr_id = static_cast<const ArrIdentifierNode*>(designator_);
-       VI mem_location = arr_id->GenerateIR(irc);
+       VI mem_location = arr_id->GenerateAddressIR(irc);
 
        // Insert a kill instruction for a store.
        VI location_value;
@@ -485,23 +487,51 @@ VI AssignmentNode::GenerateIR(IRC& irc) const {
     return result;
 }
 
-VI FunctionCallNode::GenerateIR(IRC& irc) const {
-    LOG(INFO) << "[IR] Parsing function call";
+VI AssignmentNode::GenerateIR(IRC& irc) const {
+    LOG(INFO) << "[IR] Parsing assignment";
+    
+    const ASTPool& ast = irc.ASTConst().Nodes();
+
+    auto expr_idx = ast.expressions[value_].GenerateIR(irc);
+
+    const DesignatorNode& designator = ast.designators[designator_];
+    const DesignatorNode* arr_id = nullptr;
+    if (designator.GetDesignatorType() == DESIG_ARR) {
+        arr_id = &designator;
+    }
+
+    return EmitAssignment(irc, designator.GetSymbol(), arr_id, expr_idx);
+}
 
+/*
+ * The Value for the callee is created before any of the arguments are
+ * generated.
+ */
+VI papyrus::BeginFunctionCall(IRC& irc, SymbolId func_sym) {
     VI func_call = CV(V::VAL_FUNC);
-    auto func_name = identifier_->IdentifierName();
+    CF->GetValue(func_call)->SetIdentifier(func_sym);
 
-    if (!irc.IsExistFunction(func_name)) {
-        LOG(ERROR) << "[IR] Usage of function " + func_name + " which is not defined";
-        exit(1);
+    return func_call;
+}
+
+void papyrus::EmitArgument(IRC& irc, SymbolId func_sym, VI argument) {
+    // Arguments of the intrinsics are consumed by EndFunctionCall()
+    if (irc.IsIntrinsic(SymbolName(func_sym))) {
+        return;
     }
 
-    CF->GetValue(func_call)->SetIdentifier(identifier_->IdentifierName());
+    // Let us assume here, that the arguments are pushed from L-R
+    //////////////////////////////////////////////////
+    MI(T::INS_ARG, argument);
+    //////////////////////////////////////////////////
+}
 
+VI papyrus::EndFunctionCall(IRC& irc, SymbolId func_sym, VI func_call, const std::vector<VI>& arguments) {
+    auto& func_name = SymbolName(func_sym);
 
     VI result;
     if (func_name == "InputNum") {
-        if (arguments_.size() != 0) {
+        if (arguments.size() != 0) {
             LOG(ERROR) << "[IR] Incorrect usage of InputNum() function";
             exit(1);
         }
@@ -510,16 +540,16 @@ VI FunctionCallNode::GenerateIR(IRC& irc) const {
         result = MI(T::INS_READ);
         //////////////////////////////////////////////////
     } else if (func_name == "OutputNum") {
-        if (arguments_.size() != 1) {
+        if (arguments.size() != 1) {
             LOG(ERROR) << "[IR] Incorrect usage of OutputNum() function";
             exit(1);
         }
 
         //////////////////////////////////////////////////
-        result = MI(T::INS_WRITEX, arguments_.at(0)->GenerateIR(irc));
+        result = MI(T::INS_WRITEX, arguments.at(0));
         //////////////////////////////////////////////////
     } else if (func_name == "OutputNewLine") {
-        if (arguments_.size() != 0) {
+        if (arguments.size() != 0) {
             LOG(ERROR) << "[IR] Incorrct usage of OutputNewLine() function";
             exit(1);
         }
@@ -528,15 +558,6 @@ VI FunctionCallNode::GenerateIR(IRC& irc) const {
         result = MI(T::INS_WRITENL);
         //////////////////////////////////////////////////
     } else {
-        // Let us assume here, that the arguments are pushed from L-R
-        VI interm;
-        for (auto argument: arguments_) {
-            interm = argument->GenerateIR(irc); 
-            //////////////////////////////////////////////////
-            MI(T::INS_ARG, interm);
-            //////////////////////////////////////////////////
-        }
-
         //////////////////////////////////////////////////
         result = MI(T::INS_CALL, func_call);
         //////////////////////////////////////////////////
@@ -545,36 +566,81 @@ VI FunctionCallNode::GenerateIR(IRC& irc) const {
     return result;
 }
 
-VI RelationNode::GenerateIR(IRC& irc) const {
-    LOG(INFO) << "[IR] Parsing relation";
+VI FunctionCallNode::GenerateIR(IRC& irc) const {
+    LOG(INFO) << "[IR] Parsing function call";
+
+    const ASTPool& ast = irc.ASTConst().Nodes();
+
+    auto func_sym = identifier_;
+    VI func_call = BeginFunctionCall(irc, func_sym);
 
-    VI expr_1 = left_expr_->GenerateIR(irc);
-    VI expr_2 = right_expr_->GenerateIR(irc);
+    if (!irc.IsExistFunction(SymbolName(func_sym))) {
+        LOG(ERROR) << "[IR] Usage of function " + SymbolName(func_sym) + " which is not defined";
+        exit(1);
+    }
+
+    std::vector<VI> arguments;
+    for (auto argument: ast.expression_lists.View(arguments_)) {
+        arguments.push_back(ast.expressions[argument].GenerateIR(irc));
+        EmitArgument(irc, func_sym, arguments.back());
+    }
 
+    return EndFunctionCall(irc, func_sym, func_call, arguments);
+}
+
+VI papyrus::EmitRelation(IRC& irc, VI expr_1, VI expr_2) {
     //////////////////////////////////////////////////
     return MI(T::INS_CMP, expr_1, expr_2);
     //////////////////////////////////////////////////
 }
 
+VI RelationNode::GenerateIR(IRC& irc) const {
+    LOG(INFO) << "[IR] Parsing relation";
+
+    const ASTPool& ast = irc.ASTConst().Nodes();
+
+    VI expr_1 = ast.expressions[left_expr_].GenerateIR(irc);
+    VI expr_2 = ast.expressions[right_expr_].GenerateIR(irc);
+
+    return EmitRelation(irc, expr_1, expr_2);
+}
+
 // This function is used to fold branches which can be computed at compile-time
-VI ITENode::TryReducingCmp(IRConstructor& irc, VI left, VI right) const {
+//
+// Here, we handle the case where the control flow is reducible. 
+// The reason for doing this during AST construction is that we already
+// know a lot of information about the "constantness" of the conditionals
+// It might be a waste of time to perform this as an analysis since, 
+// reducing the CFG at this stage also allows us to get rid of 
+// unnecessary PHI functions.
+int papyrus::ReduceITECondition(IRC& irc, RelationalOperator op) {
+    auto curr_ins = CF->CurrentInstruction();
+    VI left  = curr_ins->Operands().at(0);
+    VI right = curr_ins->Operands().at(1);
+
     // Check if we want to explore THEN or ELSE branch of the condition.
     // We will discard the other.
-    int THEN = 1;
-    int ELSE = 2;
-    auto op = relation_->GetOp();
     auto result = CF->ReduceCondition(op, left, right);
 
     if (result != NOTFOUND) {
         // TODO: Remove usages of exprs
         // Make current instruction inactive and remove uses of expressions
-        CF->CurrentInstruction()->MakeInactive();
-        if (result == THEN) {
-            then_sequence_->GenerateIR(irc);
-        } else if (result == ELSE) {
-            if (else_sequence_ != nullptr) {
-                else_sequence_->GenerateIR(irc);
-            }
+        CF->RemoveInstruction(CF->CurrentInstructionIdx());
+    }
+
+    return result;
+}
+
+VI ITENode::TryReducingCmp(IRConstructor& irc) const {
+    const ASTPool& ast = irc.ASTConst().Nodes();
+
+    auto result = ReduceITECondition(irc, ast.relations[relation_].GetOp());
+
+    if (result == REDUCED_THEN) {
+        ast.sequences[then_sequence_].GenerateIR(irc);
+    } else if (result == REDUCED_ELSE) {
+        if (else_sequence_.IsValid()) {
+            ast.sequences[else_sequence_].GenerateIR(irc);
         }
     }
 
@@ -585,56 +651,52 @@ VI ITENode::TryReducingCmp(IRConstructor& irc, VI left, VI right) const {
 //
 // Please read the reference paper to understand the ordering of the SealBB()
 // operations. 
-VI ITENode::GenerateIR(IRC& irc) const {
-    LOG(INFO) << "[IR] Parsing ITE";
-
-    VI result = NOTFOUND;
-
-    VI reln = relation_->GenerateIR(irc);
-    auto op = relation_->GetOp();
-
-    // Here, we handle the case where the control flow is reducible. 
-    // The reason for doing this during AST construction is that we already
-    // know a lot of information about the "constantness" of the conditionals
-    // It might be a waste of time to perform this as an analysis since, 
-    // reducing the CFG at this stage also allows us to get rid of 
-    // unnecessary PHI functions.
-    auto curr_ins = CF->CurrentInstruction();
-    VI left_expr  = curr_ins->Operands().at(0);
-    VI right_expr = curr_ins->Operands().at(1);
-
-    VI temp = TryReducingCmp(irc, left_expr, right_expr);
-    if (temp != NOTFOUND) {
-        return temp;
-    }
-
-    BI previous = CF->CurrentBBIdx();
-    CF->SealBB(previous);
+void papyrus::BeginITE(IRC& irc, ITEBlocks& ite) {
+    ite.previous = CF->CurrentBBIdx();
+    CF->SealBB(ite.previous);
 
     BI then_start  = CF->CreateBB(B::BB_THEN);
-    CF->AddBBEdge(previous, then_start);
+    CF->AddBBEdge(ite.previous, then_start);
 
     CF->SealBB(then_start);
     CF->SetCurrentBB(then_start);
+}
+
+void papyrus::BeginElse(IRC& irc, ITEBlocks& ite) {
+    ite.then_end = CF->CurrentBBIdx();
+    ite.has_else = true;
+
+    ite.else_start = CF->CreateBB(B::BB_ELSE);
+
+    CF->SetCurrentBB(ite.previous);
+    VI bb_val = CF->GetBB(ite.else_start)->GetSelfValue();
 
-    then_sequence_->GenerateIR(irc);
-    BI then_end = CF->CurrentBBIdx();
+    //////////////////////////////////////////////////
+    MI(irc.ConvertOperation(ite.op), ite.reln, bb_val);
+    //////////////////////////////////////////////////
+    
+    CF->AddBBEdge(ite.previous, ite.else_start);
+    CF->SealBB(ite.else_start);
+    CF->SetCurrentBB(ite.else_start);
+}
 
-    if (else_sequence_ == nullptr) {
+void papyrus::EndITE(IRC& irc, ITEBlocks& ite) {
+    if (!ite.has_else) {
+        BI then_end = CF->CurrentBBIdx();
         BI f_through = CF->CreateBB(B::BB_THROUGH);
 
-        CF->SetCurrentBB(previous);
+        CF->SetCurrentBB(ite.previous);
         VI bb_val = CF->GetBB(f_through)->GetSelfValue();
 
         //////////////////////////////////////////////////
-        MI(irc.ConvertOperation(op), reln, bb_val);
+        MI(irc.ConvertOperation(ite.op), ite.reln, bb_val);
         //////////////////////////////////////////////////
                             
         if (!CF->HasEndedBB(then_end)) {
             CF->AddBBEdge(then_end, f_through);
         }
 
-        CF->AddBBEdge(previous, f_through);
+        CF->AddBBEdge(ite.previous, f_through);
 
         CF->SealBB(then_end);
         CF->SealBB(f_through);
@@ -655,20 +717,7 @@ VI ITENode::GenerateIR(IRC& irc) const {
             }
         }
     } else {
-        BI else_start = CF->CreateBB(B::BB_ELSE);
-
-        CF->SetCurrentBB(previous);
-        VI bb_val = CF->GetBB(else_start)->GetSelfValue();
-
-        //////////////////////////////////////////////////
-        MI(irc.ConvertOperation(op), reln, bb_val);
-        //////////////////////////////////////////////////
-        
-        CF->AddBBEdge(previous, else_start);
-        CF->SealBB(else_start);
-        CF->SetCurrentBB(else_start);
-
-        else_sequence_->GenerateIR(irc);
+        BI then_end = ite.then_end;
         BI else_end = CF->CurrentBBIdx();
 
         CF->SealBB(then_end);
@@ -677,7 +726,7 @@ VI ITENode::GenerateIR(IRC& irc) const {
         bool then_ended = CF->HasEndedBB(then_end);
         bool else_ended = CF->HasEndedBB(else_end);
         if (then_ended && else_ended) {
-            return result;
+            return;
         }
 
         BI f_through = CF->CreateBB(B::BB_THROUGH);
@@ -720,43 +769,70 @@ VI ITENode::GenerateIR(IRC& irc) const {
             }
         }
     }
-
-    return result;
 }
 
-VI WhileNode::GenerateIR(IRC& irc) const {
-    LOG(INFO) << "[IR] Parsing While";
+VI ITENode::GenerateIR(IRC& irc) const {
+    LOG(INFO) << "[IR] Parsing ITE";
+
+    const ASTPool& ast = irc.ASTConst().Nodes();
 
     VI result = NOTFOUND;
 
+    ITEBlocks ite;
+    ite.reln = ast.relations[relation_].GenerateIR(irc);
+    ite.op   = ast.relations[relation_].GetOp();
+
+    VI temp = TryReducingCmp(irc);
+    if (temp != NOTFOUND) {
+        return temp;
+    }
+
+    BeginITE(irc, ite);
+    ast.sequences[then_sequence_].GenerateIR(irc);
+
+    if (else_sequence_.IsValid()) {
+        BeginElse(irc, ite);
+        ast.sequences[else_sequence_].GenerateIR(irc);
+    }
+
+    EndITE(irc, ite);
+
+    return result;
+}
+
+void papyrus::BeginWhile(IRC& irc, WhileBlocks& loop) {
     BI previous = CF->CurrentBBIdx();
 
-    BI loop_header = CF->CreateBB(B::BB_LOOPHEAD);
+    loop.loop_header = CF->CreateBB(B::BB_LOOPHEAD);
 
-    VI bb_val = CF->GetBB(loop_header)->GetSelfValue();
-    
     //////////////////////////////////////////////////
     // TODO: Implement loop condition checking for 
     // reducibility
     //////////////////////////////////////////////////
-    CF->AddBBEdge(previous, loop_header);
+    CF->AddBBEdge(previous, loop.loop_header);
     CF->SealBB(previous);
 
-    BI loop_body = CF->CreateBB(B::BB_LOOPBODY);
+    loop.loop_body = CF->CreateBB(B::BB_LOOPBODY);
 
-    VI next_bb = CF->CreateBB(B::BB_THROUGH);
+    loop.next_bb = CF->CreateBB(B::BB_THROUGH);
 
-    CF->AddBBEdge(loop_header, next_bb);
-    CF->AddBBEdge(loop_header, loop_body);
+    CF->AddBBEdge(loop.loop_header, loop.next_bb);
+    CF->AddBBEdge(loop.loop_header, loop.loop_body);
 
-    CF->SetCurrentBB(loop_header);
-    VI reln = loop_condition_->GenerateIR(irc);
+    CF->SetCurrentBB(loop.loop_header);
+}
+
+void papyrus::BeginLoopBody(IRC& irc, WhileBlocks& loop) {
+    CF->SealBB(loop.loop_body);
 
-    CF->SealBB(loop_body);
+    CF->SetCurrentBB(loop.loop_body);
+}
 
-    CF->SetCurrentBB(loop_body);
-    statement_sequence_->GenerateIR(irc);
-    BI loop_end = CF->CurrentBBIdx();
+void papyrus::EndWhile(IRC& irc, WhileBlocks& loop) {
+    BI loop_header = loop.loop_header;
+    BI loop_body   = loop.loop_body;
+    BI next_bb     = loop.next_bb;
+    BI loop_end    = CF->CurrentBBIdx();
 
     if (!CF->HasEndedBB(loop_end)) {
         CF->AddBBEdge(loop_end, loop_header);
@@ -772,11 +848,10 @@ VI WhileNode::GenerateIR(IRC& irc) const {
     CF->SealBB(loop_header);
 
     CF->SetCurrentBB(loop_header);
-    auto op = loop_condition_->GetOp();
 
-    bb_val = CF->GetBB(next_bb)->GetSelfValue();
+    VI bb_val = CF->GetBB(next_bb)->GetSelfValue();
     //////////////////////////////////////////////////
-    MI(irc.ConvertOperation(op), reln, bb_val);
+    MI(irc.ConvertOperation(loop.op), loop.reln, bb_val);
     //////////////////////////////////////////////////
 
     ////////////////////////////
@@ -816,16 +891,34 @@ VI WhileNode::GenerateIR(IRC& irc) const {
     }
 
     CF->SetCurrentBB(next_bb);
+}
+
+VI WhileNode::GenerateIR(IRC& irc) const {
+    LOG(INFO) << "[IR] Parsing While";
+
+    const ASTPool& ast = irc.ASTConst().Nodes();
+
+    VI result = NOTFOUND;
+
+    WhileBlocks loop;
+    BeginWhile(irc, loop);
+
+    loop.reln = ast.relations[loop_condition_].GenerateIR(irc);
+    loop.op   = ast.relations[loop_condition_].GetOp();
+
+    BeginLoopBody(irc, loop);
+    ast.sequences[statement_sequence_].GenerateIR(irc);
+
+    EndWhile(irc, loop);
+
     return result;
 }
 
-// Generate a Return Node
-VI ReturnNode::GenerateIR(IRC& irc) const {
+// interm is NOTFOUND for a return without a value
+VI papyrus::EmitReturn(IRC& irc, VI interm) {
     VI result = NOTFOUND;
 
-    VI interm;
-    if (return_expression_ != nullptr) {
-        interm = return_expression_->GenerateIR(irc);
+    if (interm != NOTFOUND) {
         //////////////////////////////////////////////////
         result = MI(T::INS_RET, interm);
         //////////////////////////////////////////////////
@@ -841,36 +934,47 @@ VI ReturnNode::GenerateIR(IRC& irc) const {
     return result;
 }
 
+// Generate a Return Node
+VI ReturnNode::GenerateIR(IRC& irc) const {
+    VI interm = NOTFOUND;
+    if (return_expression_.IsValid()) {
+        interm = irc.ASTConst().Nodes().expressions[return_expression_].GenerateIR(irc);
+    }
+
+    return EmitReturn(irc, interm);
+}
+
+
 // Handle each type of statement possible
 VI StatementNode::GenerateIR(IRC& irc) const {
     LOG(INFO) << "[IR] Parsing statement";
 
+    const ASTPool& ast = irc.ASTConst().Nodes();
+
     VI result = NOTFOUND;
     switch(statement_type_) {
         case StatementType::STAT_ASSIGN: {
-            auto assgn = static_cast<const AssignmentNode*>(this);
-            result = assgn->GenerateIR(irc);
+            result = ast.assignments[NodeRef<AssignmentNode>(index_)].GenerateIR(irc);
             break;
         }
         case StatementType::STAT_FUNCCALL: {
-            auto funcn = static_cast<const FunctionCallNode*>(this);
-            result = funcn->GenerateIR(irc);
+            result = ast.calls[NodeRef<FunctionCallNode>(index_)].GenerateIR(irc);
             break;
         }
         case StatementType::STAT_ITE: {
-            auto iten = static_cast<const ITENode*>(this);
-            result = iten->GenerateIR(irc);
+            result = ast.ites[NodeRef<ITENode>(index_)].GenerateIR(irc);
             break;
         }
         case StatementType::STAT_WHILE: {
-            auto whilen = static_cast<const WhileNode*>(this);
-            result = whilen->GenerateIR(irc);
+            result = ast.whiles[NodeRef<WhileNode>(index_)].GenerateIR(irc);
             break;
         }
         case StatementType::STAT_RETURN: {
-            auto retn = static_cast<const ReturnNode*>(this);
-            result = retn->GenerateIR(irc);
+            result = ast.returns[NodeRef<ReturnNode>(index_)].GenerateIR(irc);
+            break;
         }
+        default:
+            break;
     }
 
     return result;
@@ -878,29 +982,20 @@ VI StatementNode::GenerateIR(IRC& irc) const {
 
 // For each statement, generate a result
 void StatSequenceNode::GenerateIR(IRC& irc) const {
-    StatementNode* statement;
     VI result;
-    for (auto it = GetStatementBegin(); it != GetStatementEnd(); it++) {
-        statement = *it;
-        result = statement->GenerateIR(irc);
+    for (auto& statement: irc.ASTConst().Nodes().statement_lists.View(statements_)) {
+        result = statement.GenerateIR(irc);
     }
 
     // TODO: Generate an implicit return instruction if not already
     // generated.
 }
 
-// Simple handling of statement sequences
-void FunctionBodyNode::GenerateIR(IRC& irc) const {
-    LOG(INFO) << "[IR] Parsing function body for: " << CF->FunctionName();
-
-    func_statement_sequence_->GenerateIR(irc);
-}
-
-// Generic functions to declaring and defining functions
-void FunctionDeclNode::GenerateIR(IRC& irc) const {
-    LOG(INFO) << "[IR] Parsing function: " << identifier_->IdentifierName();
-
-    auto func_name = identifier_->IdentifierName();
+/*
+ * Creates the Function and its local variables. local_sym_table holds the
+ * formals and the locals declared by the function.
+ */
+void papyrus::BeginFunction(IRC& irc, const std::string& func_name, const SymbolTable& local_sym_table) {
     auto func = new Function(func_name, irc.ValueCounter(), irc.ValMap());
 
     irc.AddFunction(func_name, func);
@@ -908,14 +1003,13 @@ void FunctionDeclNode::GenerateIR(IRC& irc) const {
 
     int offset = 0, old_offset;
     Variable *var;
-    std::string var_name;
+    SymbolId var_name;
     Symbol *sym;
     int total_size;
     VI expr, location;
     int formal_count = 1;
 
-    auto local_sym_table = irc.ASTConst().GetLocalSymTable(func_name);
-    for (auto table_entry: local_sym_table) {
+    for (auto& table_entry: local_sym_table) {
         var_name = table_entry.first;
         sym = table_entry.second;
 
@@ -970,29 +1064,37 @@ void FunctionDeclNode::GenerateIR(IRC& irc) const {
 
         CF->AddVariable(var_name, var);
     }
+}
 
-    func_body_->GenerateIR(irc);
-
+void papyrus::EndFunction(IRC& irc) {
     irc.SetCounter(CF->GetCounter());
     irc.ClearCurrentFunction();
 }
 
-// Handle Root Computation!
-void ComputationNode::GenerateIR(IRC& irc) const {
-    LOG(INFO) << "[IR] Parsing Computation Root";
+// Generic functions to declaring and defining functions
+void FunctionDeclNode::GenerateIR(IRC& irc) const {
+    LOG(INFO) << "[IR] Parsing function: " << GetFunctionName();
+
+    auto& func_name = GetFunctionName();
+    BeginFunction(irc, func_name, irc.ASTConst().GetLocalSymTable(func_name));
+
+    irc.ASTConst().Nodes().sequences[func_body_].GenerateIR(irc);
+
+    EndFunction(irc);
+}
+
+void papyrus::DeclareGlobals(IRC& irc, const SymbolTable& global_sym_table) {
+    LOG(INFO) << "[IR] Declaring globals";
 
     int offset = 0, old_offset;
     Variable *var;
-    std::string var_name;
+    SymbolId var_name;
     Symbol *sym;
     int total_size;
     VI location;
 
-    LOG(INFO) << "[IR] Declaring globals";
-
     irc.DeclareGlobalBase();
-    auto global_sym_table = irc.ASTConst().GetGlobalSymTable();
-    for (auto table_entry: global_sym_table) {
+    for (auto& table_entry: global_sym_table) {
         sym = table_entry.second;
         total_size = 1;
         old_offset = offset;
@@ -1020,16 +1122,13 @@ void ComputationNode::GenerateIR(IRC& irc) const {
         var = new Variable(sym, old_offset, location);
         irc.AddGlobal(var_name, var);
     }
+}
 
-    // Forward declaration of functions
-    for (auto funcn: function_declarations_) {
-        irc.DeclareFunction(funcn->GetFunctionName());
-    }
-    
-    for (auto funcn: function_declarations_) {
-        funcn->GenerateIR(irc);
-    }
-
+/*
+ * Must only be called once every other function has been generated, since
+ * GlobalClobbering looks at all of them.
+ */
+void papyrus::BeginMain(IRC& irc) {
     LOG(INFO) << "[IR] Parsing main";
 
     /////////////////////////////////////////////////////////
@@ -1039,24 +1138,23 @@ void ComputationNode::GenerateIR(IRC& irc) const {
     GlobalClobbering gc = GlobalClobbering(irc);
     gc.Run();
 
-    auto clobber_status = gc.GetClobberStatus();
-    auto readdef_status = gc.GetReadDefStatus();
+    const auto& clobber_status = gc.GetClobberStatus();
+    const auto& readdef_status = gc.GetReadDefStatus();
 
-    std::unordered_set<std::string> tainted_globals = {};
-    for (auto clob_pair: clobber_status) {
+    std::unordered_set<SymbolId> tainted_globals = {};
+    for (const auto& clob_pair: clobber_status) {
         for (auto var_name: clob_pair.second) {
             tainted_globals.insert(var_name);
         }
     }
 
-    for (auto readdef_pair: readdef_status) {
+    for (const auto& readdef_pair: readdef_status) {
         for (auto var_name: readdef_pair.second) {
             tainted_globals.insert(var_name);
         }
     }
 
-    auto variables = irc.Globals();
-    for (auto var_pair: variables) {
+    for (const auto& var_pair: irc.Globals()) {
         auto var_name = var_pair.first;
         auto var      = var_pair.second;
 
@@ -1074,7 +1172,7 @@ void ComputationNode::GenerateIR(IRC& irc) const {
     irc.AddFunction(func_name, func);
     irc.SetCurrentFunction(func);
 
-    std::unordered_set<std::string> mark;
+    std::unordered_set<SymbolId> mark;
     for (auto globvar_pair: irc.Globals()) {
         auto var_name = globvar_pair.first;
         auto var = globvar_pair.second;
@@ -1087,12 +1185,9 @@ void ComputationNode::GenerateIR(IRC& irc) const {
     for (auto glob: mark) {
         irc.RemoveGlobal(glob);
     }
+}
 
-    // IR generation of "main" begins here.
-    if (computation_body_ != nullptr) {
-        computation_body_->GenerateIR(irc);
-    }
-
+void papyrus::EndMain(IRC& irc) {
     if (CF->CurrentBB()->IsSealed()) {
         CF->CurrentBB()->Seal();
     }
@@ -1100,4 +1195,34 @@ void ComputationNode::GenerateIR(IRC& irc) const {
     //////////////////////////////////////////////////
     MI(T::INS_END);
     //////////////////////////////////////////////////
+
+    // The call graph used by GlobalClobbering was built before main existed
+    irc.Analyses().Invalidate(PRESERVE_NONE);
+}
+
+// Handle Root Computation!
+void ComputationNode::GenerateIR(IRC& irc) const {
+    LOG(INFO) << "[IR] Parsing Computation Root";
+
+    const ASTPool& ast = irc.ASTConst().Nodes();
+
+    DeclareGlobals(irc, irc.ASTConst().GetGlobalSymTable());
+
+    // Forward declaration of functions
+    for (auto& funcn: ast.functions) {
+        irc.DeclareFunction(funcn.GetFunctionName());
+    }
+    
+    for (auto& funcn: ast.functions) {
+        funcn.GenerateIR(irc);
+    }
+
+    BeginMain(irc);
+
+    // IR generation of "main" begins here.
+    if (computation_body_.IsValid()) {
+        ast.sequences[computation_body_].GenerateIR(irc);
+    }
+
+    EndMain(irc);
 }
@@ -2,6 +2,83 @@
 #define PAPYRUS_ASTWALK_H
 
 #include "IRConstructor.h"
+#include "Analysis/AnalysisManager.h"
 #include "Analysis/GlobalClobbering.h"
 
+#include <string>
+#include <vector>
+
+namespace papyrus {
+
+/*
+ * IR emission helpers. Each of these emits the IR for (a part of) one
+ * production once its operands have been generated. They are called by the
+ * GenerateIR() walk over the AST, and by the FusedParser which calls them
+ * while parsing and never builds the AST. Since both go through the same
+ * code, both construct the same IR.
+ */
+
+// Results of ReduceITECondition(), same as Function::ReduceCondition()
+const int REDUCED_THEN = 1;
+const int REDUCED_ELSE = 2;
+
+// Blocks of an ITE which are carried from one step to the next
+struct ITEBlocks {
+    VI reln;
+    RelationalOperator op;
+
+    BI previous;
+    BI then_end;
+    BI else_start;
+    bool has_else = false;
+};
+
+// Blocks of a while loop which are carried from one step to the next
+struct WhileBlocks {
+    VI reln;
+    RelationalOperator op;
+
+    BI loop_header;
+    BI loop_body;
+    BI next_bb;
+};
+
+VI EmitArithmetic(IRC&, ArithmeticOperator, VI, VI);
+
+VI EmitVariableRead(IRC&, SymbolId);
+VI EmitArrayRead(IRC&, const DesignatorNode*);
+VI EmitAssignment(IRC&, SymbolId, const DesignatorNode*, VI);
+
+// BeginFunctionCall() before the arguments, EmitArgument() after each
+// of them and EndFunctionCall() once all of them have been generated.
+VI BeginFunctionCall(IRC&, SymbolId);
+void EmitArgument(IRC&, SymbolId, VI);
+VI EndFunctionCall(IRC&, SymbolId, VI, const std::vector<VI>&);
+
+VI EmitRelation(IRC&, VI, VI);
+VI EmitReturn(IRC&, VI);
+
+// Called right after the CMP of the condition has been emitted
+int ReduceITECondition(IRC&, RelationalOperator);
+
+// BeginITE() before the then sequence, BeginElse() before the else sequence
+// and EndITE() after the last sequence.
+void BeginITE(IRC&, ITEBlocks&);
+void BeginElse(IRC&, ITEBlocks&);
+void EndITE(IRC&, ITEBlocks&);
+
+// BeginWhile() before the condition, BeginLoopBody() before the body and
+// EndWhile() after it.
+void BeginWhile(IRC&, WhileBlocks&);
+void BeginLoopBody(IRC&, WhileBlocks&);
+void EndWhile(IRC&, WhileBlocks&);
+
+void DeclareGlobals(IRC&, const SymbolTable&);
+void BeginFunction(IRC&, const std::string&, const SymbolTable&);
+void EndFunction(IRC&);
+void BeginMain(IRC&);
+void EndMain(IRC&);
+
+} // namespace papyrus
+
 #endif /* PAPYRUS_ASTWALK_H */
@@ -0,0 +1,53 @@
+#ifndef PAPYRUS_CHUNKEDVECTOR_H
+#define PAPYRUS_CHUNKEDVECTOR_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace papyrus {
+
+/*
+ * An append-only sequence indexed like a vector, which stores its elements in
+ * fixed-size chunks. Unlike a vector, it never moves an element once it has
+ * been added: the IR hands out Value* and Instruction* which are held on to
+ * while more of them are created.
+ */
+template <typename T, std::size_t CHUNK_BITS = 12>
+class ChunkedVector {
+public:
+    ChunkedVector() : size_(0) {}
+
+    ChunkedVector(const ChunkedVector&) = delete;
+    ChunkedVector& operator=(const ChunkedVector&) = delete;
+
+    // Returns the index of the new element
+    template <typename... Args>
+    std::size_t EmplaceBack(Args&&... args) {
+        if ((size_ & CHUNK_MASK) == 0) {
+            chunks_.emplace_back();
+            chunks_.back().reserve(CHUNK_SIZE);
+        }
+
+        // Never reallocates, since the chunk has been reserved
+        chunks_.back().emplace_back(std::forward<Args>(args)...);
+        return size_++;
+    }
+
+    T& operator[](std::size_t idx) { return chunks_[idx >> CHUNK_BITS][idx & CHUNK_MASK]; }
+    const T& operator[](std::size_t idx) const { return chunks_[idx >> CHUNK_BITS][idx & CHUNK_MASK]; }
+
+    std::size_t Size() const { return size_; }
+    std::size_t BytesAllocated() const { return chunks_.size() * CHUNK_SIZE * sizeof(T); }
+
+private:
+    static constexpr std::size_t CHUNK_SIZE = std::size_t(1) << CHUNK_BITS;
+    static constexpr std::size_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+    std::vector<std::vector<T> > chunks_;
+    std::size_t size_;
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_CHUNKEDVECTOR_H */
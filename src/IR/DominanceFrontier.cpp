@@ -0,0 +1,88 @@
+#include "DominanceFrontier.h"
+#include "IR.h"
+
+#include <algorithm>
+
+using namespace papyrus;
+
+void DominanceFrontier::Compute(Function* fn, const DominatorTree& tree) {
+    const std::size_t num_bbs = tree.NumBBs();
+    std::vector<std::vector<BI> > frontiers(num_bbs);
+
+    for (auto bb_idx: tree.ReversePostOrder()) {
+        // The virtual exit of a post-dominator tree joins nothing
+        if (bb_idx == NO_BB) {
+            continue;
+        }
+
+        // Predecessors in the graph the tree was built on
+        auto bb = fn->GetBB(bb_idx);
+        const auto& preds = tree.IsPostDominatorTree() ? bb->Successors() : bb->Predecessors();
+        if (preds.size() < 2) {
+            continue;
+        }
+
+        BI idom = tree.IDom(bb_idx);
+        for (auto pred: preds) {
+            if (!tree.IsReachable(pred)) {
+                continue;
+            }
+
+            BI runner = pred;
+            while (runner != idom) {
+                frontiers[runner].push_back(bb_idx);
+                runner = tree.IDom(runner);
+            }
+        }
+    }
+
+    frontier_begin_.assign(num_bbs + 1, 0);
+    frontier_.clear();
+    for (std::size_t bb_idx = 0; bb_idx < num_bbs; bb_idx++) {
+        auto& frontier = frontiers[bb_idx];
+        std::sort(frontier.begin(), frontier.end());
+        frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+
+        frontier_.insert(frontier_.end(), frontier.begin(), frontier.end());
+        frontier_begin_[bb_idx + 1] = frontier_.size();
+    }
+}
+
+std::vector<BI> DominanceFrontier::IteratedFrontier(const std::vector<BI>& bbs) const {
+    const std::size_t num_bbs = frontier_begin_.empty() ? 0 : frontier_begin_.size() - 1;
+
+    std::vector<BI> result;
+    std::vector<bool> in_result(num_bbs, false);
+    std::vector<bool> queued(num_bbs, false);
+
+    std::vector<BI> worklist;
+    for (auto bb_idx: bbs) {
+        if (bb_idx >= 0 && static_cast<std::size_t>(bb_idx) < num_bbs && !queued[bb_idx]) {
+            queued[bb_idx] = true;
+            worklist.push_back(bb_idx);
+        }
+    }
+
+    // The frontier of a BB in the result is part of the result as well
+    while (!worklist.empty()) {
+        BI bb_idx = worklist.back();
+        worklist.pop_back();
+
+        for (auto frontier_idx: Frontier(bb_idx)) {
+            if (in_result[frontier_idx]) {
+                continue;
+            }
+
+            in_result[frontier_idx] = true;
+            result.push_back(frontier_idx);
+
+            if (!queued[frontier_idx]) {
+                queued[frontier_idx] = true;
+                worklist.push_back(frontier_idx);
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
@@ -0,0 +1,48 @@
+#ifndef PAPYRUS_DOMINANCEFRONTIER_H
+#define PAPYRUS_DOMINANCEFRONTIER_H
+
+#include "DominatorTree.h"
+
+#include <vector>
+
+namespace papyrus {
+
+/*
+ * DominanceFrontier holds the dominance frontier of every BB, computed from a
+ * DominatorTree with the algorithm of Cooper, Harvey and Kennedy: each join
+ * BB is added to the frontier of every BB on the way up the tree from each
+ * of its predecessors, stopping at its immediate dominator.
+ *
+ * Built from a post-dominator tree, the same walk over the reverse CFG gives
+ * the reverse dominance frontier: a BB is control dependent on the BBs in its
+ * reverse frontier.
+ *
+ * The frontiers are sorted and stored contiguously.
+ */
+class DominanceFrontier {
+public:
+    void Compute(Function*, const DominatorTree&);
+
+    // Sorted frontier of the BB, empty for BBs not in the tree
+    IteratorRange<const BI*> Frontier(BI bb_idx) const {
+        if (bb_idx < 0 || static_cast<std::size_t>(bb_idx) + 1 >= frontier_begin_.size()) {
+            return {nullptr, nullptr};
+        }
+
+        const BI* frontier = frontier_.data();
+        return {frontier + frontier_begin_[bb_idx], frontier + frontier_begin_[bb_idx + 1]};
+    }
+
+    // The iterated dominance frontier of a set of BBs, i.e. where phis are
+    // needed for a variable defined in those BBs. Sorted.
+    std::vector<BI> IteratedFrontier(const std::vector<BI>&) const;
+
+private:
+    // Frontier of bb is frontier_[frontier_begin_[bb], frontier_begin_[bb + 1])
+    std::vector<uint32_t> frontier_begin_;
+    std::vector<BI> frontier_;
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_DOMINANCEFRONTIER_H */
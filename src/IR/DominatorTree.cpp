@@ -0,0 +1,192 @@
+#include "DominatorTree.h"
+#include "IR.h"
+
+#include <algorithm>
+
+using namespace papyrus;
+
+/*
+ * Builds the tree over BBs [0, num_bbs) reachable from root. successors(bb)
+ * and predecessors(bb) return the edges of the graph, so that the same code
+ * can be run on the reverse CFG.
+ */
+template <typename SuccFn, typename PredFn>
+void DominatorTree::Build(BI root, std::size_t num_bbs, SuccFn successors, PredFn predecessors) {
+    root_ = root;
+
+    rpo_.clear();
+    rpo_number_.assign(num_bbs, UNREACHABLE);
+    idom_.assign(num_bbs, NO_BB);
+    pre_.assign(num_bbs, 0);
+    post_.assign(num_bbs, 0);
+
+    // Number the BBs in reverse postorder. Each entry of the worklist
+    // remembers how many of the successors have been looked at.
+    std::vector<std::pair<BI, std::size_t> > worklist;
+    std::vector<bool> visited(num_bbs, false);
+
+    visited[root] = true;
+    worklist.push_back({root, 0});
+    while (!worklist.empty()) {
+        auto& top = worklist.back();
+        const auto& succs = successors(top.first);
+
+        if (top.second < succs.size()) {
+            BI succ = succs[top.second++];
+            if (!visited[succ]) {
+                visited[succ] = true;
+                worklist.push_back({succ, 0});
+            }
+            continue;
+        }
+
+        rpo_.push_back(top.first);
+        worklist.pop_back();
+    }
+    std::reverse(rpo_.begin(), rpo_.end());
+
+    const std::size_t num_reachable = rpo_.size();
+    for (std::size_t i = 0; i < num_reachable; i++) {
+        rpo_number_[rpo_[i]] = i;
+    }
+
+    // Cooper, Harvey and Kennedy. doms[i] is the (current guess of the)
+    // immediate dominator of rpo_[i], as an RPO number. Dominators always
+    // come first in RPO, so the common dominator of two BBs is found by
+    // walking up from whichever of them comes later.
+    std::vector<uint32_t> doms(num_reachable, UNREACHABLE);
+    doms[0] = 0;
+
+    auto intersect = [&doms](uint32_t finger1, uint32_t finger2) {
+        while (finger1 != finger2) {
+            while (finger1 > finger2) {
+                finger1 = doms[finger1];
+            }
+            while (finger2 > finger1) {
+                finger2 = doms[finger2];
+            }
+        }
+        return finger1;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (std::size_t i = 1; i < num_reachable; i++) {
+            uint32_t new_idom = UNREACHABLE;
+
+            for (auto pred: predecessors(rpo_[i])) {
+                uint32_t pred_number = rpo_number_[pred];
+                if (pred_number == UNREACHABLE || doms[pred_number] == UNREACHABLE) {
+                    continue;
+                }
+
+                if (new_idom == UNREACHABLE) {
+                    new_idom = pred_number;
+                } else {
+                    new_idom = intersect(pred_number, new_idom);
+                }
+            }
+
+            if (doms[i] != new_idom) {
+                doms[i] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < num_reachable; i++) {
+        idom_[rpo_[i]] = rpo_[doms[i]];
+    }
+
+    // Lay out the children of each BB contiguously, in reverse postorder
+    children_begin_.assign(num_bbs + 1, 0);
+    for (std::size_t i = 1; i < num_reachable; i++) {
+        children_begin_[idom_[rpo_[i]] + 1]++;
+    }
+    for (std::size_t bb_idx = 0; bb_idx < num_bbs; bb_idx++) {
+        children_begin_[bb_idx + 1] += children_begin_[bb_idx];
+    }
+
+    children_.resize(num_reachable - 1);
+    std::vector<uint32_t> fill(children_begin_.begin(), children_begin_.end() - 1);
+    for (std::size_t i = 1; i < num_reachable; i++) {
+        BI bb_idx = rpo_[i];
+        children_[fill[idom_[bb_idx]]++] = bb_idx;
+    }
+
+    // DFS of the tree itself. A BB dominates another iff it is entered
+    // before and left after it.
+    uint32_t pre_counter = 0;
+    uint32_t post_counter = 0;
+
+    worklist.clear();
+    pre_[root] = pre_counter++;
+    worklist.push_back({root, children_begin_[root]});
+    while (!worklist.empty()) {
+        auto& top = worklist.back();
+
+        if (top.second < children_begin_[top.first + 1]) {
+            BI child = children_[top.second++];
+            pre_[child] = pre_counter++;
+            worklist.push_back({child, children_begin_[child]});
+            continue;
+        }
+
+        post_[top.first] = post_counter++;
+        worklist.pop_back();
+    }
+}
+
+void DominatorTree::Compute(Function* fn) {
+    BI max_idx = 0;
+    for (const auto& bb_pair: fn->BasicBlocks()) {
+        max_idx = std::max(max_idx, bb_pair.first);
+    }
+
+    // NOTE: BB with idx=1 is assumed to be the entry idx
+    BI entry_idx = 1;
+
+    is_post_ = false;
+    Build(entry_idx, max_idx + 1,
+          [fn](BI bb_idx) -> const std::vector<BI>& { return fn->GetBB(bb_idx)->Successors(); },
+          [fn](BI bb_idx) -> const std::vector<BI>& { return fn->GetBB(bb_idx)->Predecessors(); });
+}
+
+void DominatorTree::ComputePost(Function* fn) {
+    BI max_idx = 0;
+    for (const auto& bb_pair: fn->BasicBlocks()) {
+        max_idx = std::max(max_idx, bb_pair.first);
+    }
+
+    // Exits are the BBs which return, and those which simply have no
+    // successors (e.g. the BB ending main).
+    std::vector<BI> exits(fn->ExitBlocks());
+    for (const auto& bb_pair: fn->BasicBlocks()) {
+        if (bb_pair.second->Successors().empty()) {
+            exits.push_back(bb_pair.first);
+        }
+    }
+    std::sort(exits.begin(), exits.end());
+    exits.erase(std::unique(exits.begin(), exits.end()), exits.end());
+
+    // Edges of the reverse CFG; NO_BB is the virtual exit
+    std::vector<std::vector<BI> > reverse_preds(max_idx + 1);
+    for (auto exit_idx: exits) {
+        reverse_preds[exit_idx].push_back(NO_BB);
+    }
+    for (const auto& bb_pair: fn->BasicBlocks()) {
+        const auto& succs = bb_pair.second->Successors();
+        reverse_preds[bb_pair.first].insert(reverse_preds[bb_pair.first].end(),
+                                            succs.begin(), succs.end());
+    }
+
+    is_post_ = true;
+    Build(NO_BB, max_idx + 1,
+          [fn, &exits](BI bb_idx) -> const std::vector<BI>& {
+              return bb_idx == NO_BB ? exits : fn->GetBB(bb_idx)->Predecessors();
+          },
+          [&reverse_preds](BI bb_idx) -> const std::vector<BI>& {
+              return reverse_preds[bb_idx];
+          });
+}
@@ -0,0 +1,114 @@
+#ifndef PAPYRUS_DOMINATORTREE_H
+#define PAPYRUS_DOMINATORTREE_H
+
+#include "IteratorRange.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using BI = int; // BasicBlockIndex
+
+namespace papyrus {
+
+class Function;
+
+// BasicBlocks are numbered from 1
+constexpr BI NO_BB = 0;
+
+/*
+ * DominatorTree of the CFG of a Function, computed with the iterative
+ * algorithm of Cooper, Harvey and Kennedy ("A Simple, Fast Dominance
+ * Algorithm"). The BBs are numbered in reverse postorder of a DFS of the CFG,
+ * and the tree is built on those numbers, so that finding the common
+ * dominator of two BBs is a walk up an array.
+ *
+ * Once built, the children of every BB are stored contiguously, and the tree
+ * is numbered by a DFS of its own, so that Dominates() compares the pre and
+ * post numbers of two BBs instead of walking the tree.
+ *
+ * BBs which cannot be reached from the entry are not part of the tree.
+ *
+ * The same class holds post-dominator trees, built on the reverse CFG. Since
+ * a function can have several exits, the root of a post-dominator tree is a
+ * virtual exit numbered NO_BB, which every exit BB flows into. BBs from which
+ * no exit can be reached (endless loops) are not part of it.
+ */
+class DominatorTree {
+public:
+    DominatorTree() : root_(NO_BB), is_post_(false) {}
+
+    // Builds the tree for the CFG of the function, rooted at BB 1
+    void Compute(Function*);
+    // Builds the post-dominator tree of the function
+    void ComputePost(Function*);
+
+    BI Root() const { return root_; }
+
+    // The root is its own immediate dominator. NO_BB for unreachable BBs,
+    // and for the BBs right below the virtual root of a post-dominator tree.
+    BI IDom(BI bb_idx) const {
+        return IsReachable(bb_idx) ? idom_[bb_idx] : NO_BB;
+    }
+
+    // Children of the BB in the tree, in reverse postorder
+    IteratorRange<const BI*> Children(BI bb_idx) const {
+        if (!IsReachable(bb_idx)) {
+            return {nullptr, nullptr};
+        }
+
+        const BI* children = children_.data();
+        return {children + children_begin_[bb_idx], children + children_begin_[bb_idx + 1]};
+    }
+
+    // Every BB dominates itself
+    bool Dominates(BI dom, BI bb_idx) const {
+        return IsReachable(dom) && IsReachable(bb_idx) &&
+               pre_[dom] <= pre_[bb_idx] && post_[bb_idx] <= post_[dom];
+    }
+
+    bool StrictlyDominates(BI dom, BI bb_idx) const {
+        return dom != bb_idx && Dominates(dom, bb_idx);
+    }
+
+    bool IsPostDominatorTree() const { return is_post_; }
+
+    bool IsReachable(BI bb_idx) const {
+        return bb_idx >= 0 &&
+               static_cast<std::size_t>(bb_idx) < rpo_number_.size() &&
+               rpo_number_[bb_idx] != UNREACHABLE;
+    }
+
+    // Reachable BBs in the reverse postorder the tree was built on
+    const std::vector<BI>& ReversePostOrder() const { return rpo_; }
+    // Position of a reachable BB in ReversePostOrder()
+    uint32_t RPONumber(BI bb_idx) const { return rpo_number_[bb_idx]; }
+
+    // One more than the largest BI the tree was built for
+    std::size_t NumBBs() const { return rpo_number_.size(); }
+
+private:
+    static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+    BI root_;
+    bool is_post_;
+
+    std::vector<BI> rpo_;
+
+    // The following are indexed by BI
+    std::vector<uint32_t> rpo_number_;
+    std::vector<BI> idom_;
+    std::vector<uint32_t> pre_;
+    std::vector<uint32_t> post_;
+
+    // Children of bb are children_[children_begin_[bb], children_begin_[bb + 1])
+    std::vector<uint32_t> children_begin_;
+    std::vector<BI> children_;
+
+    template <typename SuccFn, typename PredFn>
+    void Build(BI root, std::size_t num_bbs, SuccFn, PredFn);
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_DOMINATORTREE_H */
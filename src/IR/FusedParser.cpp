@@ -0,0 +1,405 @@
+#include "FusedParser.h"
+
+using namespace papyrus;
+
+#define MUSTPARSE(x) MustParseToken(x, __func__, __LINE__)
+#define CC irc_->CurrentFunction()->CreateConstant
+
+FusedParser::FusedParser(Lexer& lexer) :
+    ASTConstructor(lexer),
+    irc_(nullptr) {}
+
+void FusedParser::CheckPendingCalls() const {
+    for (auto& call: pending_calls_) {
+        if (!irc_->IsExistFunction(SymbolName(call.first))) {
+            LOG(ERROR) << "[PARSER] Error at Line: " << call.second;
+            LOG(ERROR) << "[IR] Usage of function " + SymbolName(call.first) + " which is not defined";
+            exit(1);
+        }
+    }
+}
+
+////////////////////////////////
+// Rule: factor = designator | number | “(“ expression “)” | funcCall .
+////////////////////////////////
+VI FusedParser::ParseFactorIR() {
+    VI result = NOTFOUND;
+
+    if (Lexer::TOK_IDENT == PeekNextToken()) {
+        result = ParseDesignatorIR();
+    } else if (Lexer::TOK_NUM == PeekNextToken()) {
+        FetchToken();
+
+        result = CC(ParseCurrentTokenAsNumber());
+    } else if (Lexer::TOK_ROUND_OPEN == PeekNextToken()) {
+        FetchToken();
+
+        result = ParseExpressionIR();
+
+        FetchToken();
+        MUSTPARSE(Lexer::TOK_ROUND_CLOSED);
+    } else if (Lexer::TOK_CALL == PeekNextToken()) {
+        FetchToken();
+
+        result = ParseFunctionCallIR();
+    } else {
+        RaiseParseError("Could not parse factor.");
+    }
+
+    return result;
+}
+
+////////////////////////////////
+// Rule: term = factor { (“*” | “/”) factor}.
+////////////////////////////////
+VI FusedParser::ParseTermIR() {
+    VI idx_1 = ParseFactorIR();
+
+    while (Lexer::TOK_BINOP_MUL == PeekNextToken() ||
+           Lexer::TOK_BINOP_DIV == PeekNextToken()) {
+        FetchToken();
+
+        auto op = GetBinOperatorForToken(CurrentToken());
+        VI idx_2 = ParseFactorIR();
+
+        idx_1 = EmitArithmetic(*irc_, op, idx_1, idx_2);
+    }
+
+    return idx_1;
+}
+
+////////////////////////////////
+// Rule: expression = term {(“+” | “-”) term}.
+////////////////////////////////
+VI FusedParser::ParseExpressionIR() {
+    VI idx_1 = ParseTermIR();
+
+    while (Lexer::TOK_BINOP_ADD == PeekNextToken() ||
+           Lexer::TOK_BINOP_SUB == PeekNextToken()) {
+        FetchToken();
+
+        auto op = GetBinOperatorForToken(CurrentToken());
+        VI idx_2 = ParseTermIR();
+
+        idx_1 = EmitArithmetic(*irc_, op, idx_1, idx_2);
+    }
+
+    return idx_1;
+}
+
+////////////////////////////////
+// Rule: designator = ident{ "[" expression "]" }.
+////////////////////////////////
+VI FusedParser::ParseDesignatorIR() {
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_IDENT);
+
+    SymbolId symbol = GetSymbol();
+
+    // The indirections are parsed into the AST since they are generated in
+    // reverse
+    if (Lexer::TOK_SQUARE_OPEN == PeekNextToken()) {
+        NodeRef<DesignatorNode> designator = ParseIndirections(symbol);
+        return EmitArrayRead(*irc_, &nodes_.designators[designator]);
+    } else {
+        return EmitVariableRead(*irc_, symbol);
+    }
+}
+
+////////////////////////////////
+// Rule: assignment = “let” designator “<-” expression.
+////////////////////////////////
+void FusedParser::ParseAssignmentIR() {
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_IDENT);
+
+    SymbolId symbol = GetSymbol();
+
+    // The expression is generated before the designator. The expression may
+    // add designators to the pool, so the node is only looked up after it.
+    NodeRef<DesignatorNode> designator;
+    if (Lexer::TOK_SQUARE_OPEN == PeekNextToken()) {
+        designator = ParseIndirections(symbol);
+    }
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_LEFTARROW);
+
+    VI expr_idx = ParseExpressionIR();
+
+    const DesignatorNode* arr_id = nullptr;
+    if (designator.IsValid()) {
+        arr_id = &nodes_.designators[designator];
+    }
+
+    EmitAssignment(*irc_, symbol, arr_id, expr_idx);
+}
+
+////////////////////////////////
+// Rule: funcCall = “call” ident [ “(“ [expression { “,” expression } ] “)” ].
+////////////////////////////////
+VI FusedParser::ParseFunctionCallIR() {
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_IDENT);
+
+    SymbolId func_sym = GetSymbol();
+    VI func_call = BeginFunctionCall(*irc_, func_sym);
+
+    // The callee may be declared after the caller
+    if (!irc_->IsExistFunction(SymbolName(func_sym))) {
+        pending_calls_.push_back(std::make_pair(func_sym, GetLineNo()));
+    }
+
+    std::vector<VI> arguments;
+    if (Lexer::TOK_ROUND_OPEN == PeekNextToken()) {
+        FetchToken();
+
+        if (IsExpressionBegin(PeekNextToken())) {
+            arguments.push_back(ParseExpressionIR());
+            EmitArgument(*irc_, func_sym, arguments.back());
+
+            while (Lexer::TOK_COMMA == PeekNextToken()) {
+                FetchToken();
+                arguments.push_back(ParseExpressionIR());
+                EmitArgument(*irc_, func_sym, arguments.back());
+            }
+        }
+
+        FetchToken();
+        MUSTPARSE(Lexer::TOK_ROUND_CLOSED);
+    }
+
+    return EndFunctionCall(*irc_, func_sym, func_call, arguments);
+}
+
+////////////////////////////////
+// Rule: relation = expression relOp expression .
+////////////////////////////////
+VI FusedParser::ParseRelationIR(RelationalOperator& rel_op) {
+    VI left_expr = ParseExpressionIR();
+
+    if (!IsRelationalOp(PeekNextToken())) {
+        RaiseParseError("Expected relational operator in relation");
+    }
+
+    FetchToken();
+    rel_op = GetRelOperatorForToken(CurrentToken());
+
+    VI right_expr = ParseExpressionIR();
+
+    return EmitRelation(*irc_, left_expr, right_expr);
+}
+
+////////////////////////////////
+// Rule: ifStatement = “if” relation “then” statSequence [ “else” statSequence ] “fi”.
+////////////////////////////////
+void FusedParser::ParseITEIR() {
+    ITEBlocks ite;
+    ite.reln = ParseRelationIR(ite.op);
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_THEN);
+
+    // If the condition is a constant, only one of the branches is generated.
+    // The other one is parsed into the AST and dropped.
+    int reduced = ReduceITECondition(*irc_, ite.op);
+    if (reduced != NOTFOUND) {
+        if (reduced == REDUCED_THEN) {
+            ParseStatementSequenceIR();
+        } else {
+            ParseStatementSequence();
+        }
+
+        if (Lexer::TOK_ELSE == PeekNextToken()) {
+            FetchToken();
+
+            if (reduced == REDUCED_ELSE) {
+                ParseStatementSequenceIR();
+            } else {
+                ParseStatementSequence();
+            }
+        }
+    } else {
+        BeginITE(*irc_, ite);
+        ParseStatementSequenceIR();
+
+        if (Lexer::TOK_ELSE == PeekNextToken()) {
+            FetchToken();
+
+            BeginElse(*irc_, ite);
+            ParseStatementSequenceIR();
+        }
+
+        EndITE(*irc_, ite);
+    }
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_FI);
+}
+
+////////////////////////////////
+// Rule: whileStatement = “while” relation “do” StatSequence “od”.
+////////////////////////////////
+void FusedParser::ParseWhileIR() {
+    WhileBlocks loop;
+    BeginWhile(*irc_, loop);
+
+    loop.reln = ParseRelationIR(loop.op);
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_DO);
+
+    BeginLoopBody(*irc_, loop);
+    ParseStatementSequenceIR();
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_OD);
+
+    EndWhile(*irc_, loop);
+}
+
+////////////////////////////////
+// Rule: returnStatement = “return” [ expression ] .
+////////////////////////////////
+void FusedParser::ParseReturnIR() {
+    VI interm = NOTFOUND;
+
+    if (IsExpressionBegin(PeekNextToken())) {
+        interm = ParseExpressionIR();
+    }
+
+    EmitReturn(*irc_, interm);
+}
+
+////////////////////////////////
+// Rule: statement = assignment | funcCall | ifStatement | whileStatement | returnStatement.
+////////////////////////////////
+void FusedParser::ParseStatementIR() {
+    // Nodes from the previous statement are not referenced anymore
+    nodes_.Clear();
+
+    FetchToken();
+    if (Lexer::TOK_LET == CurrentToken()) {
+        ParseAssignmentIR();
+    } else if (Lexer::TOK_CALL == CurrentToken()) {
+        ParseFunctionCallIR();
+    } else if (Lexer::TOK_IF == CurrentToken()) {
+        ParseITEIR();
+    } else if (Lexer::TOK_WHILE == CurrentToken()) {
+        ParseWhileIR();
+    } else if (Lexer::TOK_RETURN == CurrentToken()) {
+        ParseReturnIR();
+    } else {
+        RaiseParseError("Statement not valid");
+    }
+}
+
+////////////////////////////////
+// Rule: statSequence = statement { “;” statement }.
+////////////////////////////////
+void FusedParser::ParseStatementSequenceIR() {
+    ParseStatementIR();
+
+    while (Lexer::TOK_SEMICOLON == PeekNextToken()) {
+        FetchToken();
+        ParseStatementIR();
+    }
+}
+
+////////////////////////////////
+// Rule: funcDecl = (“function” | “procedure”) ident [formalParam] “;” funcBody “;” .
+// Rule: funcBody = { varDecl } “{” [ statSequence ] “}”.
+////////////////////////////////
+void FusedParser::ParseFunctionDeclIR() {
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_IDENT);
+
+    ////////////////////////////////////////////
+    current_scope_ = SymbolName(GetSymbol());
+    symbol_table_[current_scope_] = {};
+    ////////////////////////////////////////////
+
+    if (Lexer::TOK_ROUND_OPEN == PeekNextToken()) {
+        ParseFormalParameters();
+    }
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_SEMICOLON);
+
+    while (Lexer::TOK_VAR == PeekNextToken() ||
+        Lexer::TOK_ARRAY == PeekNextToken()) {
+        ParseVariableDecl();
+    }
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_CURLY_OPEN);
+
+    LOG(INFO) << "[IR] Parsing function: " << current_scope_;
+
+    irc_->DeclareFunction(current_scope_);
+    BeginFunction(*irc_, current_scope_, local_symbol_table_);
+
+    ParseStatementSequenceIR();
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_CURLY_CLOSED);
+
+    EndFunction(*irc_);
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_SEMICOLON);
+}
+
+////////////////////////////////
+// Rule: computation = “main” { varDecl } { funcDecl } “{” statSequence “}” “.” .
+////////////////////////////////
+void FusedParser::BuildIR(IRConstructor& irc) {
+    irc_ = &irc;
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_MAIN);
+
+    ////////////////////////////////////////////
+    current_scope_ = "global";
+    ////////////////////////////////////////////
+    while (Lexer::TOK_VAR == PeekNextToken() ||
+           Lexer::TOK_ARRAY == PeekNextToken()) {
+        ParseVariableDecl();
+    }
+
+    DeclareGlobals(irc, global_symbol_table_);
+
+    while (Lexer::TOK_FUNCTION == PeekNextToken() ||
+           Lexer::TOK_PROCEDURE == PeekNextToken()) {
+        FetchToken();
+
+        ParseFunctionDeclIR();
+
+        symbol_table_[current_scope_] = std::move(local_symbol_table_);
+        local_symbol_table_.clear();
+    }
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_CURLY_OPEN);
+
+    ////////////////////////////////////////////
+    current_scope_ = "global";
+    ////////////////////////////////////////////
+    CheckPendingCalls();
+
+    BeginMain(irc);
+
+    if (Lexer::TOK_CURLY_CLOSED != PeekNextToken()) {
+        ParseStatementSequenceIR();
+    }
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_CURLY_CLOSED);
+
+    FetchToken();
+    MUSTPARSE(Lexer::TOK_DOT);
+
+    EndMain(irc);
+
+    nodes_.Clear();
+}
@@ -0,0 +1,70 @@
+#ifndef PAPYRUS_FUSEDPARSER_H
+#define PAPYRUS_FUSEDPARSER_H
+
+#include "Papyrus/Logger/Logger.h"
+#include "FrontEnd/ASTConstructor.h"
+#include "IRConstructor.h"
+#include "ASTWalk.h"
+
+#include <utility>
+#include <vector>
+
+namespace papyrus {
+
+/*
+ * FusedParser parses the program and constructs the IR in the same pass.
+ * Instead of building the AST, every production calls the IR emission
+ * helpers of ASTWalk.h (and through them MakeInstruction, ReadVariable and
+ * WriteVariable) as soon as it has been parsed. The helpers are the ones
+ * GenerateIR() uses, and they are called in the same order, hence the IR is
+ * the same as the one from ConstructAST() followed by BuildIR().
+ *
+ * A few constructs are still parsed into (short lived) AST nodes, since
+ * their IR is not emitted in source order:
+ *
+ * - Array designators: the indirections are generated innermost first.
+ * - The branch of an ITE which is folded away because its condition is a
+ *   constant. It is parsed to get past it, and is then dropped.
+ *
+ * The AST pools are cleared before every statement, since none of these
+ * nodes outlive the statement they are a part of.
+ *
+ * As for the AST walk, every function has to be generated before main, so
+ * that GlobalClobbering can look at them. The grammar already declares all
+ * functions before the body of main.
+ */
+class FusedParser : public ASTConstructor {
+public:
+    FusedParser(Lexer&);
+
+    void BuildIR(IRConstructor&);
+
+private:
+    IRConstructor* irc_;
+
+    // Calls to functions which had not been declared at the point of the
+    // call. These are checked once all functions have been declared.
+    std::vector<std::pair<SymbolId, int> > pending_calls_;
+
+    void CheckPendingCalls() const;
+
+    ////////////////////////////////
+    VI ParseFactorIR();
+    VI ParseTermIR();
+    VI ParseExpressionIR();
+    VI ParseDesignatorIR();
+    VI ParseRelationIR(RelationalOperator&);
+    VI ParseFunctionCallIR();
+    void ParseAssignmentIR();
+    void ParseITEIR();
+    void ParseWhileIR();
+    void ParseReturnIR();
+    void ParseStatementIR();
+    void ParseStatementSequenceIR();
+    void ParseFunctionDeclIR();
+    ////////////////////////////////
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_FUSEDPARSER_H */
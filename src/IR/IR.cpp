@@ -5,9 +5,71 @@ using namespace papyrus;
 #define NOTFOUND -1 
 
 Value::Value(ValueType vty) :
+    first_use_(NO_USE),
+    last_use_(NO_USE),
+    num_uses_(0),
+    val_(0),
+    identifier_(NO_SYMBOL),
     vty_(vty) {}
 
-Function::Function(const std::string& func_name, VI value_counter, std::unordered_map<VI, Value*>* value_map):
+UI ValueTable::AddUse(VI val_idx, II ins_idx) {
+    CheckNotConcurrent();
+
+    UI use_idx = static_cast<UI>(uses_.EmplaceBack(val_idx, ins_idx));
+    LinkUse(use_idx, val_idx);
+
+    return use_idx;
+}
+
+// Appends the use to the list of val_idx
+void ValueTable::LinkUse(UI use_idx, VI val_idx) {
+    auto lock = LockList(val_idx);
+
+    Value* val = Get(val_idx);
+    Use& use = uses_[use_idx];
+
+    use.value = val_idx;
+    use.prev  = val->last_use_;
+    use.next  = NO_USE;
+
+    if (val->last_use_ == NO_USE) {
+        val->first_use_ = use_idx;
+    } else {
+        uses_[val->last_use_].next = use_idx;
+    }
+
+    val->last_use_ = use_idx;
+    val->num_uses_++;
+}
+
+void ValueTable::RemoveUse(UI use_idx) {
+    const Use& use = uses_[use_idx];
+    // The use itself belongs to one function, only its neighbours are shared
+    auto lock = LockList(use.value);
+
+    Value* val = Get(use.value);
+
+    if (use.prev == NO_USE) {
+        val->first_use_ = use.next;
+    } else {
+        uses_[use.prev].next = use.next;
+    }
+
+    if (use.next == NO_USE) {
+        val->last_use_ = use.prev;
+    } else {
+        uses_[use.next].prev = use.prev;
+    }
+
+    val->num_uses_--;
+}
+
+void ValueTable::MoveUse(UI use_idx, VI val_idx) {
+    RemoveUse(use_idx);
+    LinkUse(use_idx, val_idx);
+}
+
+Function::Function(const std::string& func_name, VI value_counter, ValueTable* value_map):
     func_name_(func_name),
     value_counter_(value_counter),
     bb_counter_(0),
@@ -15,65 +77,60 @@ Function::Function(const std::string& func_name, VI value_counter, std::unordere
     instruction_counter_(0),
     postorder_cfg_({}),
     rev_postorder_cfg_({}),
+    valid_analyses_(PRESERVE_NONE),
     hash_map_({}),
     back_edges_({}),
     constant_map_({}),
     load_contributors_({}),
     load_related_insts_({}),
     is_killed_({}),
-    dominator_tree_({}),
-    dominance_frontier_({}),
     value_map_(value_map) {
+        instructions_.EmplaceBack(T::INS_NONE, 0, 0);
+        instructions_[0].MakeInactive();
+
         SetLocalBase(CreateValue(V::VAL_LOCALBASE));
         SetCurrentBB(CreateBB(B::BB_START));
         // Seal the Start basic block since it has no predecessors
         SealBB(CurrentBBIdx());
 }
 
-const Variable* Function::GetVariable(const std::string& var_name) const { 
+const Variable* Function::GetVariable(SymbolId var_name) const { 
     return variable_map_.at(var_name); 
 }
 
-void Function::AddVariable(const std::string& var_name, Variable* var) {
+void Function::AddVariable(SymbolId var_name, Variable* var) {
     if (IsVariableLocal(var_name)) {
-        LOG(ERROR) << "[IR] Attempt to redefine local variable " + var_name;
+        LOG(ERROR) << "[IR] Attempt to redefine local variable " + SymbolName(var_name);
         exit(1);
     }
 
     variable_map_[var_name] = var;
 }
 
-void Function::LoadFormal(const std::string& var_name) {
+void Function::LoadFormal(SymbolId var_name) {
     loaded_formals_.insert(var_name);
 }
 
-bool Function::IsVariableLocal(const std::string& var_name) const {
+bool Function::IsVariableLocal(SymbolId var_name) const {
     return variable_map_.find(var_name) != variable_map_.end();
 }
 
-bool Function::IsVariableFormal(const std::string& var_name) const {
+bool Function::IsVariableFormal(SymbolId var_name) const {
     return variable_map_.at(var_name)->IsFormal();
 }
 
-bool Function::IsFormalLoaded(const std::string& var_name) const {
+bool Function::IsFormalLoaded(SymbolId var_name) const {
     return loaded_formals_.find(var_name) != loaded_formals_.end();
 }
 
-int Function::GetOffset(const std::string& var_name) const {
+int Function::GetOffset(SymbolId var_name) const {
     return variable_map_.at(var_name)->Offset();
 }
 
-// This is the Value generation API template code. When generating a value there
-// are 2 main things to take care of:
-//
-// 1. Value Counter should be incremented. The NEW value_counter is the idx of the 
-// new value.
-// 2. Pointer to the new Value should be inserted into the Value map.
+// This is the Value generation API template code. The ValueTable hands out the
+// next index, which becomes the value_counter_ of the function.
 VI Function::CreateValue(V vty) {
-    Value* val = new Value(vty);
-
-    value_counter_++;
-    value_map_->emplace(value_counter_, val);
+    value_counter_ = value_map_->Create(vty);
 
     return value_counter_;
 }
@@ -83,11 +140,8 @@ VI Function::CreateConstant(int val) {
         return constant_map_.at(val);
     }
 
-    Value* v = new Value(V::VAL_CONST);
-    v->SetConstant(val); 
-
-    value_counter_++;
-    value_map_->emplace(value_counter_, v);
+    value_counter_ = value_map_->Create(V::VAL_CONST);
+    value_map_->Get(value_counter_)->SetConstant(val);
 
     constant_map_.insert({val, value_counter_});
 
@@ -95,11 +149,11 @@ VI Function::CreateConstant(int val) {
 }
 
 void Function::AddUsage(VI val_idx, II ins_idx) {
-    value_map_->at(val_idx)->AddUsage(ins_idx);
+    value_map_->AddUse(val_idx, ins_idx);
 }
 
 Value* Function::GetValue(VI val_idx) const {
-    return value_map_->at(val_idx);
+    return value_map_->Get(val_idx);
 }
 
 void Function::SetValueType(VI val_idx, V val_type) {
@@ -117,27 +171,23 @@ void Function::SetValueType(VI val_idx, V val_type) {
 BI Function::CreateBB(B bb_type) {
     bb_counter_++;
 
-    BasicBlock* bb = new BasicBlock(bb_counter_, bb_type);
+    BasicBlock* bb = new BasicBlock(bb_counter_, bb_type, &instructions_);
     basic_block_map_[bb_counter_] = bb;
 
     VI sv = CreateValue(V::VAL_BRANCH);
     GetValue(sv)->SetConstant(bb_counter_);
     bb->SetSelfValue(sv);
 
+    InvalidateAnalyses(PRESERVE_NONE);
+
     return bb_counter_;
 }
 
 void Function::AddBBEdge(BI pred, BI succ) {
     AddBBPredecessor(succ, pred);
     AddBBSuccessor(pred, succ);
-}
-
-const std::unordered_map<BI, BasicBlock*> Function::BasicBlocks() const {
-    return basic_block_map_;
-}
 
-const std::unordered_map<std::string, Variable*> Function::Variables() const {
-    return variable_map_;
+    InvalidateAnalyses(PRESERVE_NONE);
 }
 
 BasicBlock* Function::GetBB(BI bb_idx) const {
@@ -156,12 +206,114 @@ void Function::AddBBSuccessor(BI source, BI pred) {
     basic_block_map_[source]->AddSuccessor(pred);
 }
 
+/*
+ * Puts a new BB on the edge pred -> succ and returns it. The new BB branches
+ * to succ, the branches of pred to succ now go to the new BB, and the phis of
+ * succ take their operand from the new BB instead of pred.
+ */
+BI Function::SplitEdge(BI pred, BI succ) {
+    BI new_idx = CreateBB(B::BB_THROUGH);
+
+    BasicBlock* new_bb  = GetBB(new_idx);
+    BasicBlock* pred_bb = GetBB(pred);
+    BasicBlock* succ_bb = GetBB(succ);
+
+    pred_bb->ReplaceSuccessor(succ, new_idx);
+    succ_bb->ReplacePredecessor(pred, new_idx);
+    new_bb->AddPredecessor(pred);
+    new_bb->AddSuccessor(succ);
+    new_bb->Seal();
+
+    if (IsBackEdge(pred, succ)) {
+        back_edges_.erase(pred);
+        AddBackEdge(new_idx, succ);
+    }
+
+    VI succ_value = succ_bb->GetSelfValue();
+    VI new_value  = new_bb->GetSelfValue();
+
+    ValueTable& values = Values();
+    auto uses = values.Uses(succ_value);
+    for (auto it = uses.begin(); it != uses.end(); ) {
+        // Step past the use before it is moved over to the other list
+        UI use_idx = *it++;
+
+        Instruction* user = GetInstruction(values.GetUse(use_idx).user);
+        if (user->IsActive() && user->ContainingBB() == pred) {
+            user->ReplaceUse(succ_value, new_value);
+            values.MoveUse(use_idx, new_value);
+        }
+    }
+
+    // Phis may come after the kills at the top of the BB
+    const auto& succ_preds = succ_bb->Predecessors();
+    for (auto ins_idx: succ_bb->InstructionOrder()) {
+        Instruction* ins = GetInstruction(ins_idx);
+        if (!ins->IsPhi()) {
+            continue;
+        }
+
+        ins->ReplaceSource(pred, new_idx);
+
+        for (auto source: ins->Sources()) {
+            if (std::find(succ_preds.begin(), succ_preds.end(), source) == succ_preds.end()) {
+                LOG(ERROR) << "[IR] Phi " << ins_idx << " of BB_" << succ << " in " << func_name_
+                           << " takes an operand from BB_" << source << ", which is not a predecessor";
+                exit(1);
+            }
+        }
+    }
+
+    BI current_bb = current_bb_;
+    SetCurrentBB(new_idx);
+    MakeInstruction(T::INS_BRA, succ_value);
+    SetCurrentBB(current_bb);
+
+    InvalidateAnalyses(PRESERVE_NONE);
+
+    return new_idx;
+}
+
+/*
+ * Returns the preheader of the loop, i.e. the only BB entering the loop, if
+ * the header is its only successor. Otherwise, the edge entering the loop is
+ * split to make one. Loops entered from more than one BB cannot be written
+ * in PL241, and are not handled.
+ */
+BI Function::InsertPreheader(LI loop_idx) {
+    const LoopInfo& loops = Loops();
+    BI header = loops.GetLoop(loop_idx).header;
+
+    std::vector<BI> entries;
+    for (auto pred: GetBB(header)->Predecessors()) {
+        if (!loops.Contains(loop_idx, pred)) {
+            entries.push_back(pred);
+        }
+    }
+
+    if (entries.size() != 1) {
+        LOG(ERROR) << "[IR] Loop at BB_" << header << " of " << func_name_
+                   << " is entered from " << entries.size() << " BBs";
+        exit(1);
+    }
+
+    BI entry = entries.at(0);
+    if (GetBB(entry)->Successors().size() == 1) {
+        return entry;
+    }
+
+    return SplitEdge(entry, header);
+}
+
 bool Function::HasEndedBB(BI bb_idx) const {
     return GetBB(bb_idx)->HasEnded();
 }
 
 void Function::AddExitBlock(BI bb_idx) {
     exit_blocks_.push_back(bb_idx);
+
+    // Post-dominators are rooted at the exits
+    InvalidateAnalyses(~(ANALYSIS_POST_DOMINATORS | ANALYSIS_REVERSE_DOMINANCE_FRONTIER));
 }
 
 void Function::AddBackEdge(BI from, BI to) {
@@ -199,15 +351,8 @@ const std::unordered_set<VI> Function::GetKilledValues(BI bb_idx) const {
 // XXX:
 // MakeMove is deprecated since the instruction is not required
 // to be a part of the IR.
-void Function::MakeMove(const std::string& var_name, VI expr_idx) {
-    instruction_counter_++;
-
-    Instruction* inst = new Instruction(T::INS_MOVE,
-                                        CurrentBBIdx(),
-                                        instruction_counter_);
-
-    instruction_map_[instruction_counter_] = inst;
-    instruction_order_.push_back(instruction_counter_);
+void Function::MakeMove(SymbolId var_name, VI expr_idx) {
+    Instruction* inst = GetInstruction(NewInstruction(T::INS_MOVE));
 
     VI temp_value = CreateValue(V::VAL_VAR);
     GetValue(temp_value)->SetIdentifier(var_name);
@@ -215,11 +360,11 @@ void Function::MakeMove(const std::string& var_name, VI expr_idx) {
     inst->AddOperand(expr_idx);
     inst->AddOperand(temp_value);
 
-    CurrentBB()->AddInstruction(instruction_counter_, inst);
+    CurrentBB()->AddInstruction(instruction_counter_);
 }
 
 BI Function::GetBBForInstruction(II ins_idx) {
-    return instruction_map_[ins_idx]->ContainingBB();
+    return GetInstruction(ins_idx)->ContainingBB();
 }
 
 /*
@@ -228,30 +373,27 @@ BI Function::GetBBForInstruction(II ins_idx) {
  * if we are building the same instruction again (since we almost 
  * navigate across the CFG in dominating order
  *
- * The hash is built such that:
+ * The hash is an InstructionKey of:
  *
- * INSTRUCTION_ARG1_ARG2
+ * (INSTRUCTION, ARG1, ARG2)
  * OR
- * INSTRUCTION_ARG1
+ * (INSTRUCTION, ARG1)
  *
- * Here, arguments are sorted and hence the generated hash will be unique.
- * We will just reuse the value generated earlier.
+ * Here, arguments of commutative instructions are sorted and hence the
+ * generated hash will be unique. We will just reuse the value generated
+ * earlier.
  */
-std::string Function::HashInstruction(T insty) const {
+InstructionKey Function::HashInstruction(T insty) const {
     // Handle function calls here.
     // We could also get around calling the same functions here
     // I guess the conditions for that are that the function should not clobber
     // anything and should generate the same result for the same input
     // This is tough to check at this stage of the analysis however.
-    return "NOTFOUND";
+    return InstructionKey();
 }
 
-std::string Function::HashInstruction(T insty, VI arg_1) const {
-    std::string return_str = "";
-    return_str            += ins_to_str_.at(insty) + "_";
-    return_str            += std::to_string(arg_1);
-
-    return return_str;
+InstructionKey Function::HashInstruction(T insty, VI arg_1) const {
+    return InstructionKey(insty, arg_1);
 }
 
 bool Function::IsCommutative(T insty) const {
@@ -264,36 +406,37 @@ bool Function::IsCommutative(T insty) const {
     }
 }
 
-std::string Function::HashInstruction(T insty, VI arg_1, VI arg_2) const {
-    std::string return_str = "";
-    return_str += ins_to_str_.at(insty) + "_";
-
-    if (IsCommutative(insty)) {
-        if (arg_1 < arg_2) {
-            return_str += std::to_string(arg_1) + "_";
-            return_str += std::to_string(arg_2);
-        } else {
-            return_str += std::to_string(arg_2) + "_";
-            return_str += std::to_string(arg_1);
-        }
-    } else {
-        return_str += std::to_string(arg_1) + "_";
-        return_str += std::to_string(arg_2);
+InstructionKey Function::HashInstruction(T insty, VI arg_1, VI arg_2) const {
+    if (IsCommutative(insty) && arg_2 < arg_1) {
+        std::swap(arg_1, arg_2);
     }
 
-    return return_str;
+    return InstructionKey(insty, arg_1, arg_2);
+}
+
+bool Function::HashExists(const InstructionKey& key) const {
+    return (hash_map_.find(key) != hash_map_.end());
 }
 
-bool Function::HashExists(const std::string& hash_str) const {
-    return (hash_map_.find(hash_str) != hash_map_.end());
+void Function::InsertHash(const InstructionKey& key, VI result) {
+    hash_map_[key] = result;
 }
 
-void Function::InsertHash(const std::string& hash_str, VI result) {
-    hash_map_[hash_str] = result;
+VI Function::GetHash(const InstructionKey& key) const {
+    return hash_map_.at(key);
 }
 
-VI Function::GetHash(const std::string& hash_str) const {
-    return hash_map_.at(hash_str);
+std::ostream& papyrus::operator<<(std::ostream& os, const InstructionKey& key) {
+    if (key.arity == 0) {
+        return os << "NOTFOUND";
+    }
+
+    os << ins_to_str_.at(key.type) << "_" << key.arg_1;
+    if (key.arity == 2) {
+        os << "_" << key.arg_2;
+    }
+
+    return os;
 }
 
 /*
@@ -331,30 +474,26 @@ bool Function::IsEliminable(T insty) const {
 // BB.
 // 4. A Result Value is generated and returned.
 VI Function::MakeInstruction(T insty) {
-    instruction_counter_++;
-    Instruction* inst = new Instruction(insty, CurrentBBIdx(), instruction_counter_);
-
-    instruction_map_[instruction_counter_] = inst;
-    instruction_order_.push_back(instruction_counter_);
+    Instruction* inst = GetInstruction(NewInstruction(insty));
 
     V vty = V::VAL_ANY;
     
     VI result = CreateValue(vty);
     inst->SetResult(result);
 
-    CurrentBB()->AddInstruction(instruction_counter_, inst);
+    CurrentBB()->AddInstruction(instruction_counter_);
 
     return result;
 }
 
 VI Function::MakeInstruction(T insty, VI arg_1) {
-    auto hash_str = HashInstruction(insty, arg_1);
+    auto key = HashInstruction(insty, arg_1);
 
     // Check if instruction can be removed
     if (IsEliminable(insty)) {
-        if (HashExists(hash_str)) {
-            LOG(INFO) << "Removed " << hash_str;
-            return GetHash(hash_str);
+        if (HashExists(key)) {
+            LOG(INFO) << "Removed " << key;
+            return GetHash(key);
         }
     }
 
@@ -364,23 +503,23 @@ VI Function::MakeInstruction(T insty, VI arg_1) {
     AddUsage(arg_1, instruction_counter_);
 
     if (IsEliminable(insty)) {
-        InsertHash(hash_str, result);
+        InsertHash(key, result);
     }
 
     return result;
 }
 
 VI Function::MakeInstruction(T insty, VI arg_1, VI arg_2) {
-    auto hash_str = HashInstruction(insty, arg_1, arg_2);
+    auto key = HashInstruction(insty, arg_1, arg_2);
 
     // Check if instruction can be removed
     if (IsEliminable(insty)) {
         // TODO: The reasoning behind this is that GlobalBase will create long
         // ranges and hence interfere with all values.
         // (arg_1 != 1 || arg_2 != 1)) {
-        if (HashExists(hash_str)) {
-            LOG(INFO) << "Removed " << hash_str;
-            return GetHash(hash_str);
+        if (HashExists(key)) {
+            LOG(INFO) << "Removed " << key;
+            return GetHash(key);
         }
     }
 
@@ -393,7 +532,7 @@ VI Function::MakeInstruction(T insty, VI arg_1, VI arg_2) {
     AddUsage(arg_2, instruction_counter_);
 
     if (IsEliminable(insty)) {
-        InsertHash(hash_str, result);
+        InsertHash(key, result);
     }
 
     return result;
@@ -402,18 +541,14 @@ VI Function::MakeInstruction(T insty, VI arg_1, VI arg_2) {
 // Special
 // Add Instruction to front of instruction order.
 VI Function::MakeInstructionFront(T insty) {
-    instruction_counter_++;
-    Instruction* inst = new Instruction(insty, CurrentBBIdx(), instruction_counter_);
-
-    instruction_map_[instruction_counter_] = inst;
-    instruction_order_.push_front(instruction_counter_);
+    Instruction* inst = GetInstruction(NewInstruction(insty));
 
     V vty = V::VAL_ANY;
     
     VI result = CreateValue(vty);
     inst->SetResult(result);
 
-    CurrentBB()->AddInstructionFront(instruction_counter_, inst);
+    CurrentBB()->AddInstructionFront(instruction_counter_);
 
     return result;
 }
@@ -431,76 +566,92 @@ VI Function::MakeInstructionFront(T insty, VI arg_1) {
 // Special
 // Make Phi Instruction
 II Function::MakePhi() {
-    instruction_counter_++;
-
-    Instruction* inst = new Instruction(T::INS_PHI,
-                                        CurrentBBIdx(),
-                                        instruction_counter_);
-
-    instruction_map_[instruction_counter_] = inst;
-    instruction_order_.push_front(instruction_counter_);
+    Instruction* inst = GetInstruction(NewInstruction(T::INS_PHI));
 
     VI result = CreateValue(V::VAL_PHI);
     inst->SetResult(result);
 
-    CurrentBB()->AddInstruction(instruction_counter_, inst);
+    // Phis always go to the top of the BB
+    CurrentBB()->AddInstructionFront(instruction_counter_);
+
+    return instruction_counter_;
+}
+
+// Creates an instruction in the current BB and makes it the current
+// instruction. Placing it in the instruction order of the BB is left to
+// the caller.
+II Function::NewInstruction(T insty) {
+    instruction_counter_ = static_cast<II>(instructions_.Size());
+    instructions_.EmplaceBack(insty, CurrentBBIdx(), instruction_counter_);
 
     return instruction_counter_;
 }
 
-// Static function?
-std::vector<BI> Function::PostOrderCFG() {
-    if (postorder_cfg_.size() != 0) {
-        return postorder_cfg_;
+void Function::ComputeCFGOrder() {
+    postorder_cfg_ = PostOrder(false);
+    rev_postorder_cfg_ = std::vector<BI>(postorder_cfg_.rbegin(), postorder_cfg_.rend());
+}
+
+const std::vector<BI>& Function::PostOrderCFG() {
+    if (!IsAnalysisValid(ANALYSIS_CFG_ORDER)) {
+        ComputeCFGOrder();
+        valid_analyses_ |= ANALYSIS_CFG_ORDER;
     }
 
-    std::unordered_set<BI> visited;
-    // NOTE: BB with idx=1 is assumed to be the entry idx
-    //
-    // Here, there could be multiple entry indexes into the function. This could
-    // happen if there is a jump from another function somewhere into the middle
-    // of an instruction of the current function.
-    //
-    // However, that is an issue for another day.
-    BI entry_idx = 1;
+    return postorder_cfg_;
+}
 
-    std::stack<BI> worklist;
-    worklist.push(entry_idx);
+const std::vector<BI>& Function::ReversePostOrderCFG() {
+    // Computed along with PostOrderCFG
+    PostOrderCFG();
 
-    while (!worklist.empty()) {
-        auto bb_idx = worklist.top();
-        visited.insert(bb_idx);
+    return rev_postorder_cfg_;
+}
+
+std::vector<BI> Function::ForwardPostOrder() const {
+    return PostOrder(true);
+}
 
-        auto bb = GetBB(bb_idx);
+/*
+ * The successors of a BB are walked in order, and a BB is placed once all of
+ * them are, so this is the order of the recursive walk it replaces, without
+ * a stack frame per BB of the longest path. Each BB is placed exactly once.
+ */
+std::vector<BI> Function::PostOrder(bool skip_back_edges) const {
+    std::vector<BI> postorder;
+    std::unordered_set<BI> visited;
 
-        bool keep_on_stack = false;
-        for (auto succ: bb->Successors()) {
-            if (visited.find(succ) == visited.end()) {
-                keep_on_stack = true;
-                worklist.push(succ);
-            }
-        }
+    // BB and the number of its successors walked so far
+    std::vector<std::pair<BI, std::size_t> > worklist;
 
-        if (keep_on_stack)
-            continue;
+    // NOTE: BB with idx=1 is assumed to be the entry idx
+    BI entry_idx = 1;
+    worklist.push_back({entry_idx, 0});
+    visited.insert(entry_idx);
 
-        worklist.pop();
-        postorder_cfg_.push_back(bb_idx);
-    }
+    while (!worklist.empty()) {
+        auto& top = worklist.back();
+        const auto& successors = GetBB(top.first)->Successors();
 
-    rev_postorder_cfg_ = std::vector<BI>(postorder_cfg_.rbegin(), postorder_cfg_.rend());
+        if (top.second < successors.size()) {
+            auto from = top.first;
+            auto succ = successors[top.second++];
 
-    return postorder_cfg_;
-}
+            if (skip_back_edges && GetBB(succ)->Type() == B::BB_LOOPHEAD &&
+                IsBackEdge(from, succ)) {
+                continue;
+            }
 
-std::vector<BI> Function::ReversePostOrderCFG() {
-    // Compute PostOrderCFG if not previously computed. ReversePostOrderCFG also
-    // computed along with it.
-    if (postorder_cfg_.size() == 0) {
-        PostOrderCFG();
+            if (visited.insert(succ).second) {
+                worklist.push_back({succ, 0});
+            }
+        } else {
+            postorder.push_back(top.first);
+            worklist.pop_back();
+        }
     }
 
-    return rev_postorder_cfg_;
+    return postorder;
 }
 
 /*
@@ -528,176 +679,63 @@ std::unordered_set<BI> UnorderedSetUnion(const std::unordered_set<BI> &in1,
     return out;
 }
 
-// Implementation of iterative method of dominator tree computation
-// void Function::ComputeDominatorTree() {
-//     if (dominator_tree_.size() != 0)
-//         return;
-// 
-//     std::unordered_set<BI> all_bbs_;
-//     for (auto bb_pair: basic_block_map_) {
-//         all_bbs_.insert(bb_pair.first);
-//     }
-// 
-//     // Set entry dominator value
-//     dominator_tree_[1] = {1};
-//     for (auto bb_idx: all_bbs_) {
-//         if (bb_idx == 1)
-//             continue;
-// 
-//         dominator_tree_[bb_idx] = std::unordered_set<BI>(all_bbs_);
-//     }
-// 
-//     bool changed = true;
-//     std::unordered_set<BI> current_dom;
-// 
-//     while (changed) {
-//         changed = false;
-//         for (auto bb_idx: rev_postorder_cfg_) {
-//             if (bb_idx == 1)
-//                 continue;
-// 
-//             current_dom.clear();
-// 
-//             auto bb = GetBB(bb_idx);
-//             for (auto pred: bb->Predecessors()) {
-// 
-//                 if (current_dom.size() == 0) {
-//                     current_dom = dominator_tree_[pred];
-//                 } else {
-//                     current_dom = UnorderedSetIntersect(current_dom, dominator_tree_[pred]);
-//                 }
-//             }
-// 
-//             current_dom.insert(bb_idx);
-// 
-//             if (current_dom != dominator_tree_[bb_idx]) {
-//                 dominator_tree_[bb_idx] = current_dom;
-//                 changed = true;
-//             }
-//         }
-//     }
-// }
-
-void Function::ComputeDominatorTree() {
-    for (auto bb_pair: basic_block_map_) {
-        dominator_tree_[bb_pair.first] = -1;
-    }
-
-    auto entry_idx = 1;
-    dominator_tree_[entry_idx] = entry_idx;
-    BI new_idom;
-
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        for (auto bb_idx: rev_postorder_cfg_) {
-            if (bb_idx == entry_idx)
-                continue;
-
-            auto bb = GetBB(bb_idx);
-            auto preds = bb->Predecessors();
-
-            new_idom = *preds.begin();
-            for (auto pred: preds) {
-                if (pred == new_idom)
-                    continue;
-
-                if (dominator_tree_[pred] != -1) {
-                    new_idom = Intersect(pred, new_idom);
-                }
-            }
-
-            if (dominator_tree_[bb_idx] != new_idom) {
-                dominator_tree_[bb_idx] = new_idom;
-                changed = true;
-            }
-        }
+const DominatorTree& Function::Dominators() {
+    if (!IsAnalysisValid(ANALYSIS_DOMINATORS)) {
+        dom_tree_.Compute(this);
+        valid_analyses_ |= ANALYSIS_DOMINATORS;
     }
-}
-
-int GetIndex(const std::vector<BI> vec, BI elem) {
-    auto it = std::find(vec.begin(), vec.end(), elem);
 
-    if (it != vec.end()) {
-        return std::distance(vec.begin(), it);
-    } else {
-        return -1;
-    }
+    return dom_tree_;
 }
 
-BI Function::Intersect(BI b1, BI b2) {
-    BI finger1 = GetIndex(rev_postorder_cfg_, b1);
-    BI finger2 = GetIndex(rev_postorder_cfg_, b2);
-
-    while (b1 != b2) {
-        while (finger1 > finger2) {
-            b1 = dominator_tree_[b1];
-            finger1 = GetIndex(rev_postorder_cfg_, b1);
-        }
-        while (finger2 > finger1) {
-            b2 = dominator_tree_[b2];
-            finger2 = GetIndex(rev_postorder_cfg_, b2);
-        }
+const DominatorTree& Function::PostDominators() {
+    if (!IsAnalysisValid(ANALYSIS_POST_DOMINATORS)) {
+        post_dom_tree_.ComputePost(this);
+        valid_analyses_ |= ANALYSIS_POST_DOMINATORS;
     }
 
-    return b1;
-}
-
-const std::unordered_map<BI, BI>& Function::DominatorTree() const {
-    return dominator_tree_;
+    return post_dom_tree_;
 }
 
-void Function::ComputeDominanceFrontier() {
-    ComputeDominatorTree();
-
-    BI runner = 0;
-    bool found = false;
-    BI doms;
-
-    for (auto bb_pair: basic_block_map_) {
-        auto bb_idx = bb_pair.first;
-        auto bb = bb_pair.second;
+const DominanceFrontier& Function::DominanceFrontiers() {
+    if (!IsAnalysisValid(ANALYSIS_DOMINANCE_FRONTIER)) {
+        dom_frontier_.Compute(this, Dominators());
+        valid_analyses_ |= ANALYSIS_DOMINANCE_FRONTIER;
+    }
 
-        auto preds = bb->Predecessors();
-        if (preds.size() >= 2) {
-            for (auto pred: preds) {
-                runner = pred;
+    return dom_frontier_;
+}
 
-                if (dominance_frontier_.find(runner) == dominance_frontier_.end()) {
-                    dominance_frontier_[runner] = -1;
-                }
+const DominanceFrontier& Function::ReverseDominanceFrontiers() {
+    if (!IsAnalysisValid(ANALYSIS_REVERSE_DOMINANCE_FRONTIER)) {
+        reverse_dom_frontier_.Compute(this, PostDominators());
+        valid_analyses_ |= ANALYSIS_REVERSE_DOMINANCE_FRONTIER;
+    }
 
-                doms = dominator_tree_[bb_idx];
+    return reverse_dom_frontier_;
+}
 
-                if (doms == runner) {
-                    dominance_frontier_[runner] = bb_idx;
-                } else {
-                    found = false;
-                    while (!found) {
-                        dominance_frontier_[runner] = bb_idx;
-                        runner = dominator_tree_[runner];
-
-                        if (doms == runner) {
-                            found = true;
-                            break;
-                        }
-                    }
-                }
-            }
-        }
+const LoopInfo& Function::Loops() {
+    if (!IsAnalysisValid(ANALYSIS_LOOPS)) {
+        loop_info_.Compute(this, Dominators());
+        valid_analyses_ |= ANALYSIS_LOOPS;
     }
-}
 
-const std::unordered_map<BI, BI>& Function::DominanceFrontier() const {
-    return dominance_frontier_;
+    return loop_info_;
 }
 
-std::vector<BI> Function::ExitBlocks() {
-    return exit_blocks_;
+// The results are kept around, so that they can be recomputed in place
+void Function::InvalidateAnalyses(PreservedAnalyses preserved) {
+    valid_analyses_ &= preserved;
 }
 
 Instruction* Function::GetInstruction(II ins_idx) const {
-    return instruction_map_.at(ins_idx);
+    if (ins_idx <= 0 || static_cast<std::size_t>(ins_idx) >= instructions_.Size()) {
+        LOG(ERROR) << "[IR] Invalid instruction index " << ins_idx << " in " << func_name_;
+        exit(1);
+    }
+
+    return const_cast<Instruction*>(&instructions_[ins_idx]);
 }
 
 Instruction* Function::CurrentInstruction() const {
@@ -709,7 +747,19 @@ II Function::CurrentInstructionIdx() const {
 }
 
 bool Function::IsActive(II ins_idx) const {
-    return instruction_map_.at(ins_idx)->IsActive();
+    return GetInstruction(ins_idx)->IsActive();
+}
+
+// Takes the instruction out of its BB. The instruction itself stays around,
+// inactive, since its II may still be referred to (e.g. by uses of values).
+void Function::RemoveInstruction(II ins_idx) {
+    Instruction* ins = GetInstruction(ins_idx);
+    if (!ins->IsActive()) {
+        return;
+    }
+
+    GetBB(ins->ContainingBB())->Instructions().Erase(ins_idx);
+    ins->MakeInactive();
 }
 
 bool Function::IsRelational(T insty) const {
@@ -860,12 +910,12 @@ int Function::ReduceCondition(RelationalOperator op, VI left, VI right) const {
     return result;
 }
 
-VI Function::GetLocationValue(const std::string& var_name) const {
+VI Function::GetLocationValue(SymbolId var_name) const {
     return GetVariable(var_name)->GetLocationIdx();
 }
 
 VI Function::ResultForInstruction(II ins_idx) const {
-    return instruction_map_.at(ins_idx)->Result();
+    return GetInstruction(ins_idx)->Result();
 }
 
 void Function::AddArrContributor(II ins_idx, II result) {
@@ -896,10 +946,12 @@ const std::unordered_map<II, std::unordered_set<II> >& Function::LoadRelatedInst
  * Function definitions for instructions
  */
 Instruction::Instruction(T insty, BI containing_bb, II ins_idx) :
-    ins_type_(insty),
-    containing_bb_(containing_bb),
+    result_(NO_VALUE),
     ins_idx_(ins_idx),
-    op_source_({}),
+    containing_bb_(containing_bb),
+    prev_(NO_INSTRUCTION),
+    next_(NO_INSTRUCTION),
+    ins_type_(insty),
     is_active_(true) {}
 
 void Instruction::AddOperand(VI val_idx) {
@@ -912,31 +964,42 @@ void Instruction::AddOperand(VI val_idx) {
  */
 void Instruction::AddOperand(VI val_idx, BI pred) {
     AddOperand(val_idx);
-    op_source_[pred] = val_idx;
+    sources_.push_back(pred);
+}
+
+void Instruction::ReplaceSource(BI old_idx, BI new_idx) {
+    std::replace(sources_.begin(), sources_.end(), old_idx, new_idx);
 }
 
-std::string Instruction::HashOfInstruction() const {
-    std::string ret_val = "";
+VI Instruction::OperandFrom(BI pred) const {
+    for (std::size_t i = 0; i < sources_.size(); i++) {
+        if (sources_[i] == pred) {
+            return operands_[i];
+        }
+    }
+
+    return NO_VALUE;
+}
+
+// Unlike Function::HashInstruction, operands are taken in the order they
+// appear, and only the first two of them are used.
+InstructionKey Instruction::HashOfInstruction() const {
     if (operands_.size() == 0) {
-        ret_val = "NOTFOUND";
+        return InstructionKey();
     } else if (operands_.size() == 1) {
-        ret_val += ins_to_str_.at(ins_type_) + "_";
-        ret_val += std::to_string(operands_.at(0));
+        return InstructionKey(ins_type_, operands_[0]);
     } else {
-        ret_val += ins_to_str_.at(ins_type_) + "_";
-        ret_val += std::to_string(operands_.at(0)) + "_";
-        ret_val += std::to_string(operands_.at(1));
+        return InstructionKey(ins_type_, operands_[0], operands_[1]);
     }
-
-    return ret_val;
 }
 
 /*
  * Function definitions for BBs
  */
-BasicBlock::BasicBlock(BI idx, B type) :
+BasicBlock::BasicBlock(BI idx, B type, ChunkedVector<Instruction>* instructions) :
     idx_(idx),
     type_(type),
+    instruction_order_(instructions, idx),
     is_sealed_(false),
     is_dead_(false),
     is_ended_(false) {}
@@ -949,43 +1012,100 @@ void BasicBlock::AddSuccessor(BI succ_idx) {
     successors_.push_back(succ_idx);
 }
 
-void BasicBlock::AddInstruction(II idx, Instruction* inst) {
-    instructions_[idx] = inst;
-    
-    if (inst->IsPhi()) {
-        instruction_order_.push_front(idx);
+void BasicBlock::ReplacePredecessor(BI old_idx, BI new_idx) {
+    std::replace(predecessors_.begin(), predecessors_.end(), old_idx, new_idx);
+}
+
+void BasicBlock::ReplaceSuccessor(BI old_idx, BI new_idx) {
+    std::replace(successors_.begin(), successors_.end(), old_idx, new_idx);
+}
+
+void BasicBlock::AddInstruction(II idx) {
+    instruction_order_.PushBack(idx);
+}
+
+void BasicBlock::AddInstructionFront(II idx) {
+    instruction_order_.PushFront(idx);
+}
+
+II BasicBlock::GetPreviousInstruction(II ins_idx) const {
+    return instruction_order_.Prev(ins_idx);
+}
+
+/*
+ * Function definitions for InstructionList
+ */
+InstructionList::InstructionList(ChunkedVector<Instruction>* pool, BI bb_idx) :
+    pool_(pool),
+    bb_idx_(bb_idx),
+    front_(NO_INSTRUCTION),
+    back_(NO_INSTRUCTION),
+    size_(0) {}
+
+// Places idx between prev and next, either of which may be NO_INSTRUCTION
+void InstructionList::Link(II prev, II idx, II next) {
+    Instruction& ins = At(idx);
+    ins.prev_ = prev;
+    ins.next_ = next;
+    ins.containing_bb_ = bb_idx_;
+
+    if (prev == NO_INSTRUCTION) {
+        front_ = idx;
+    } else {
+        At(prev).next_ = idx;
+    }
+
+    if (next == NO_INSTRUCTION) {
+        back_ = idx;
     } else {
-        instruction_order_.push_back(idx);
+        At(next).prev_ = idx;
     }
+
+    size_++;
 }
 
-void BasicBlock::AddInstructionFront(II idx, Instruction* inst) {
-    instructions_[idx] = inst;
-    
-    instruction_order_.push_front(idx);
+void InstructionList::PushBack(II idx) {
+    Link(back_, idx, NO_INSTRUCTION);
 }
 
-const std::vector<BI> BasicBlock::Predecessors() const {
-    return predecessors_;
+void InstructionList::PushFront(II idx) {
+    Link(NO_INSTRUCTION, idx, front_);
 }
 
-const std::vector<BI> BasicBlock::Successors() const {
-    return successors_;
+void InstructionList::InsertBefore(II pos, II idx) {
+    Link(At(pos).prev_, idx, pos);
 }
 
-bool BasicBlock::HasActiveInstructions() const {
-    Instruction* ins;
-    for (auto ins_pair: instructions_) {
-        ins = ins_pair.second;
-        if (ins->IsActive()) {
-            return true;
-        }
+void InstructionList::InsertAfter(II pos, II idx) {
+    Link(pos, idx, At(pos).next_);
+}
+
+// The links of the erased instruction are left alone, so that an iterator
+// pointing at it can still be advanced.
+void InstructionList::Erase(II idx) {
+    const Instruction& ins = At(idx);
+
+    if (ins.prev_ == NO_INSTRUCTION) {
+        front_ = ins.next_;
+    } else {
+        At(ins.prev_).next_ = ins.next_;
+    }
+
+    if (ins.next_ == NO_INSTRUCTION) {
+        back_ = ins.prev_;
+    } else {
+        At(ins.next_).prev_ = ins.prev_;
     }
 
-    return false;
+    size_--;
 }
 
-II BasicBlock::GetPreviousInstruction(II ins_idx) const {
-    auto it = std::find(instruction_order_.begin(), instruction_order_.end(), ins_idx);
-    return (*it - 1);
+void InstructionList::MoveTo(II idx, InstructionList& dest, II pos) {
+    Erase(idx);
+
+    if (pos == NO_INSTRUCTION) {
+        dest.PushBack(idx);
+    } else {
+        dest.InsertBefore(pos, idx);
+    }
 }
@@ -3,12 +3,21 @@
 
 #include "Papyrus/Logger/Logger.h"
 #include "FrontEnd/Operation.h"
+#include "ChunkedVector.h"
+#include "DominanceFrontier.h"
+#include "DominatorTree.h"
+#include "LoopInfo.h"
+#include "PreservedAnalyses.h"
+#include "IteratorRange.h"
+#include "SmallVector.h"
 #include "Variable.h"
 
 #include <vector>
 #include <algorithm>
 
 #include <deque>
+#include <memory>
+#include <mutex>
 #include <map>
 #include <string>
 #include <stack>
@@ -18,17 +27,42 @@
 using VI = int; // ValueIndex
 using BI = int; // BasicBlockIndex
 using II = int; // InstructionIndex
+using UI = int; // UseIndex
 
 namespace papyrus {
 
 class IRConstructor;
+class InstructionList;
+struct InstructionKey;
+
+// Instructions are numbered from 1 in each function
+constexpr II NO_INSTRUCTION = 0;
+// Uses are numbered from 1
+constexpr UI NO_USE = 0;
+// Values are numbered from 1
+constexpr VI NO_VALUE = 0;
+
+/*
+ * A Use records that an instruction uses a value. All the uses of a value are
+ * linked up in a doubly-linked list running through the Uses themselves, so
+ * a use can be removed, or moved over to another value, in O(1).
+ */
+struct Use {
+    Use(VI val, II ins) : value(val), user(ins), prev(NO_USE), next(NO_USE) {}
+
+    VI value;
+    II user;
+
+    UI prev;
+    UI next;
+};
 
 /*
  * Value class describes the fundamental value in the compiler.
  */
 class Value {
 public:
-    enum ValueType {
+    enum ValueType : uint8_t {
         VAL_ANY,
 
         VAL_CONST,
@@ -45,49 +79,189 @@ public:
         VAL_NONE // Just in case
     };
 
-    Value(ValueType);
+    Value(ValueType = VAL_NONE);
 
-    const std::vector<II>& GetUsers() const { return uses_; }
     const ValueType Type() const { return vty_; }
 
     void SetType(ValueType vty) { vty_ = vty; }
-    void AddUsage(II ins_idx) { uses_.push_back(ins_idx); }
     void SetConstant(int val) { val_ = val; }
-    void SetIdentifier(const std::string& ident) { identifier_ = ident; }
-    void RemoveUse(II);
+    void SetIdentifier(SymbolId ident) { identifier_ = ident; }
 
-    void SetDepth(int depth) { loop_depth_ = depth; }
-    void SetSpillCost(long double cost) { spill_cost_ = cost; }
+    // The uses themselves are kept by the ValueTable
+    std::size_t NumUses() const { return num_uses_; }
 
-    std::string Identifier() const { return identifier_; }
+    SymbolId GetSymbol() const { return identifier_; }
+    const std::string& Identifier() const { return SymbolName(identifier_); }
 
     int GetConstant() const { return val_; }
 
-    int LoopDepth() const { return loop_depth_; }
-    long double SpillCost() const { return spill_cost_; }
-
     bool IsConstant() const { return vty_ == VAL_CONST; }
 
 private:
-    // ValueType for each value describes the "type" of the value. The distinction
-    // is blurry but it serves its purpose during IR construction and visualization
-    ValueType vty_;
+    friend class ValueTable;
+
+    // Ends of the list of uses of the value in various instructions
+    UI first_use_;
+    UI last_use_;
+    uint32_t num_uses_;
 
     // If the value is a constant (number), val_ contains that constant value
     int val_;
-    
-    // loop_depth_ and spill_cost_ are used during Register Allocation to determine
-    // how much "costly" the value is for spilling
-    int loop_depth_;
-    long double spill_cost_;
 
     // In case the value is a variable or global which can be identified, the
-    // identifier is stored (also helps during the visualization phase)
-    std::string identifier_;
+    // identifier is stored (also helps during the visualization phase).
+    // NO_SYMBOL otherwise.
+    SymbolId identifier_;
 
-    // uses_ vector contains all the uses of the value in various instructions
-    // inside the function
-    std::vector<II> uses_;
+    // ValueType for each value describes the "type" of the value. The distinction
+    // is blurry but it serves its purpose during IR construction and visualization
+    ValueType vty_;
+};
+
+/*
+ * ValueTable holds every Value of the program, indexed directly by VI. Value
+ * indices are handed out densely starting from 1 (0 is never a valid value),
+ * and are shared by all functions.
+ *
+ * Values are stored in fixed-size chunks, so that a Value* stays valid while
+ * more values are created. The Uses of all values are pooled the same way.
+ *
+ * Loop depth and spill cost are only needed by the register allocator and are
+ * kept in a side table, which is only allocated once they are set.
+ */
+class ValueTable {
+public:
+    class UseIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = UI;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const UI*;
+        using reference         = UI;
+
+        UseIterator(const ValueTable* table, UI idx) : table_(table), idx_(idx) {}
+
+        UI operator*() const { return idx_; }
+
+        UseIterator& operator++() {
+            idx_ = table_->GetUse(idx_).next;
+            return *this;
+        }
+        UseIterator operator++(int) {
+            UseIterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const UseIterator& other) const { return idx_ == other.idx_; }
+        bool operator!=(const UseIterator& other) const { return idx_ != other.idx_; }
+
+    private:
+        const ValueTable* table_;
+        UI idx_;
+    };
+
+    // Index 0 is never handed out
+    ValueTable() : concurrent_(false) {
+        values_.EmplaceBack();
+        uses_.EmplaceBack(0, NO_INSTRUCTION);
+    }
+
+    ValueTable(const ValueTable&) = delete;
+    ValueTable& operator=(const ValueTable&) = delete;
+
+    // Creates a value and returns its index
+    VI Create(Value::ValueType vty) {
+        CheckNotConcurrent();
+        return static_cast<VI>(values_.EmplaceBack(vty));
+    }
+
+    Value* Get(VI idx) const {
+        if (idx <= 0 || static_cast<std::size_t>(idx) >= values_.Size()) {
+            LOG(ERROR) << "[IR] Invalid value index " << idx;
+            exit(1);
+        }
+
+        return const_cast<Value*>(&values_[idx]);
+    }
+
+    // One more than the largest index
+    std::size_t Size() const { return values_.Size(); }
+    std::size_t BytesAllocated() const {
+        return values_.BytesAllocated() + uses_.BytesAllocated() +
+               spill_info_.capacity() * sizeof(SpillInfo);
+    }
+
+    // Records a use of the value by the instruction, at the end of the
+    // uses of the value
+    UI AddUse(VI, II);
+    // Unlinks the use from its value. The removed use keeps its links, so an
+    // iterator pointing at it can still be advanced.
+    void RemoveUse(UI);
+    // Moves the use over to the end of the uses of another value
+    void MoveUse(UI, VI);
+
+    const Use& GetUse(UI idx) const { return uses_[idx]; }
+
+    // The uses of a value, in the order they were added
+    IteratorRange<UseIterator> Uses(VI idx) const {
+        return {UseIterator(this, Get(idx)->first_use_), UseIterator(this, NO_USE)};
+    }
+
+    int LoopDepth(VI idx) const {
+        return static_cast<std::size_t>(idx) < spill_info_.size() ? spill_info_[idx].loop_depth : 0;
+    }
+    float SpillCost(VI idx) const {
+        return static_cast<std::size_t>(idx) < spill_info_.size() ? spill_info_[idx].spill_cost : 0;
+    }
+    void SetLoopDepth(VI idx, int depth) { GetSpillInfo(idx).loop_depth = depth; }
+    void SetSpillCost(VI idx, float cost) { GetSpillInfo(idx).spill_cost = cost; }
+
+    // While functions are transformed in parallel, the uses of values shared
+    // between functions (globals, functions, the GlobalBase) can be moved and
+    // removed from several threads, so each edit locks the list it touches.
+    // Creating values or uses would reallocate the tables under the readers,
+    // and is not allowed in the meantime.
+    void SetConcurrent(bool concurrent) { concurrent_ = concurrent; }
+
+private:
+    static constexpr std::size_t NUM_LIST_LOCKS = 64;
+
+    std::mutex list_locks_[NUM_LIST_LOCKS];
+    bool concurrent_;
+
+    std::unique_lock<std::mutex> LockList(VI idx) {
+        if (!concurrent_) {
+            return {};
+        }
+        return std::unique_lock<std::mutex>(list_locks_[idx % NUM_LIST_LOCKS]);
+    }
+
+    void CheckNotConcurrent() const {
+        if (concurrent_) {
+            LOG(ERROR) << "[IR] Values cannot be created while functions are processed in parallel";
+            exit(1);
+        }
+    }
+
+    struct SpillInfo {
+        int loop_depth = 0;
+        float spill_cost = 0;
+    };
+
+    ChunkedVector<Value> values_;
+    ChunkedVector<Use> uses_;
+
+    std::vector<SpillInfo> spill_info_;
+
+    void LinkUse(UI, VI);
+
+    SpillInfo& GetSpillInfo(VI idx) {
+        if (static_cast<std::size_t>(idx) >= spill_info_.size()) {
+            spill_info_.resize(values_.Size());
+        }
+        return spill_info_[idx];
+    }
 };
 
 /*
@@ -95,7 +269,7 @@ private:
  */
 class Instruction {
 public:
-    enum InstructionType {
+    enum InstructionType : uint8_t {
         INS_NONE,
 
         INS_ADDA,
@@ -154,27 +328,37 @@ public:
 
     InstructionType Type() const { return ins_type_; }
 
-    const std::vector<VI>& Operands() const { return operands_; }
+    const SmallVector<VI, 3>& Operands() const { return operands_; }
 
     II Index() const { return ins_idx_; }
 
     std::string ConvertToString() const;
-    std::string HashOfInstruction() const;
+    InstructionKey HashOfInstruction() const;
 
     bool IsPhi() const { return ins_type_ == INS_PHI; }
     bool IsKill() const { return ins_type_ == INS_KILL; }
     bool IsActive() const { return is_active_; }
 
-    const std::unordered_map<BI, VI> OpSource() { return op_source_; }
+    // Phi only: the BB each operand flows in from, in operand order
+    const SmallVector<BI, 2>& Sources() const { return sources_; }
+    // Phi only: the operand flowing in from the BB, NO_VALUE if there is none
+    VI OperandFrom(BI) const;
+    // Phi only: the operand flowing in from the first BB now flows in from
+    // the second one
+    void ReplaceSource(BI, BI);
 
 private:
-    // For each instruction, we store the type of the instruction. Unlike 
-    // that for `Value` this field is well-defined and important
-    InstructionType ins_type_;
+    friend class InstructionList;
+
+    // Operands (ValueIndex) of the instruction. Up to 3 are kept inline;
+    // only phis and calls with more operands go to the heap.
+    SmallVector<VI, 3> operands_;
+
+    // Currently implemented only for Phi
+    // sources_[i] is the BasicBlock, ideally a predecessor of the
+    // containing_bb, which operands_[i] flows in from
+    SmallVector<BI, 2> sources_;
 
-    // Vector of operands (ValueIndex) for the instruction
-    std::vector<VI> operands_;
-    
     // ValueIndex of the result
     VI result_;
 
@@ -184,18 +368,109 @@ private:
     // Index of BasicBlock containing the instruction
     BI containing_bb_;
 
-    // Currently implemented only for Phi
-    // For each BasicBlock, ideally the predecessor of the containing_bb, this 
-    // tells is which value flows into the current instruction
-    std::unordered_map<BI, VI> op_source_;
-
-    // Instructions are not deleted in the IR, rather they are made "inactive".
-    // This allows us to get around memory issues such as use-after-free. It 
-    // might make sense to keep the deleted instructions around since some
-    // analyses might require them.
+    // Neighbours in the InstructionList of the containing BB
+    II prev_;
+    II next_;
+
+    // For each instruction, we store the type of the instruction. Unlike 
+    // that for `Value` this field is well-defined and important
+    InstructionType ins_type_;
+
+    // Instructions are never freed: a removed instruction is taken out of its
+    // BB and made "inactive", so that its II stays valid for anyone still
+    // holding on to it.
     bool is_active_;
 };
 
+/*
+ * InstructionList is the ordered list of instructions of a BasicBlock. It is
+ * intrusive: the links live in the Instructions, which are owned by the
+ * Function, so inserting, erasing or moving an instruction anywhere in the
+ * list is O(1) and allocates nothing. Inserting an instruction into the list
+ * makes its BB the containing BB of the instruction.
+ *
+ * Iterators point at an instruction and stay valid while the list is edited.
+ * An erased instruction keeps its links until it is inserted again, so a
+ * pass may erase the instruction it is looking at and then move on.
+ */
+class InstructionList {
+public:
+    template <bool REVERSE>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = II;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const II*;
+        using reference         = II;
+
+        Iterator(const InstructionList* list, II idx) : list_(list), idx_(idx) {}
+
+        II operator*() const { return idx_; }
+
+        Iterator& operator++() {
+            idx_ = REVERSE ? list_->Prev(idx_) : list_->Next(idx_);
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const { return idx_ == other.idx_; }
+        bool operator!=(const Iterator& other) const { return idx_ != other.idx_; }
+
+    private:
+        const InstructionList* list_;
+        II idx_;
+    };
+
+    using iterator         = Iterator<false>;
+    using reverse_iterator = Iterator<true>;
+
+    InstructionList(ChunkedVector<Instruction>*, BI);
+
+    InstructionList(const InstructionList&) = delete;
+    InstructionList& operator=(const InstructionList&) = delete;
+
+    iterator begin() const { return iterator(this, front_); }
+    iterator end() const { return iterator(this, NO_INSTRUCTION); }
+    reverse_iterator rbegin() const { return reverse_iterator(this, back_); }
+    reverse_iterator rend() const { return reverse_iterator(this, NO_INSTRUCTION); }
+
+    // NO_INSTRUCTION if the list is empty
+    II Front() const { return front_; }
+    II Back() const { return back_; }
+
+    // NO_INSTRUCTION at either end of the list
+    II Next(II idx) const { return At(idx).next_; }
+    II Prev(II idx) const { return At(idx).prev_; }
+
+    std::size_t Size() const { return size_; }
+    bool Empty() const { return size_ == 0; }
+
+    void PushBack(II);
+    void PushFront(II);
+    void InsertBefore(II pos, II);
+    void InsertAfter(II pos, II);
+    void Erase(II);
+    // Erases the instruction and inserts it into dest before pos, or at
+    // the end of dest if pos is NO_INSTRUCTION
+    void MoveTo(II, InstructionList& dest, II pos);
+
+private:
+    ChunkedVector<Instruction>* pool_;
+    BI bb_idx_;
+
+    II front_;
+    II back_;
+    std::size_t size_;
+
+    Instruction& At(II idx) const { return (*pool_)[idx]; }
+    void Link(II prev, II idx, II next);
+};
+
 using T = Instruction::InstructionType;
 using V = Value::ValueType;
 
@@ -246,6 +521,56 @@ static const std::unordered_map<T, std::string> ins_to_str_ = {
     {T::INS_WRITENL, "writenl"},
 };
 
+/*
+ * InstructionKey identifies an instruction by its type and (at most two)
+ * operands, and is used for value numbering. Keys are plain integers, so
+ * building, hashing and comparing them does not allocate.
+ *
+ * Keys of instructions without operands carry no type; like the string
+ * hashes these replaced, they all compare equal.
+ */
+struct InstructionKey {
+    InstructionKey() : type(T::INS_NONE), arity(0), arg_1(0), arg_2(0) {}
+    InstructionKey(T insty, VI arg) : type(insty), arity(1), arg_1(arg), arg_2(0) {}
+    InstructionKey(T insty, VI arg1, VI arg2) : type(insty), arity(2), arg_1(arg1), arg_2(arg2) {}
+
+    bool operator==(const InstructionKey& other) const {
+        return type  == other.type  &&
+               arity == other.arity &&
+               arg_1 == other.arg_1 &&
+               arg_2 == other.arg_2;
+    }
+
+    T type;
+    uint8_t arity;
+    VI arg_1;
+    VI arg_2;
+};
+
+struct InstructionKeyHash {
+    std::size_t operator()(const InstructionKey& key) const {
+        uint64_t h = (static_cast<uint64_t>(static_cast<uint32_t>(key.arg_1)) << 32) |
+                      static_cast<uint32_t>(key.arg_2);
+        h ^= (static_cast<uint64_t>(key.type) | (static_cast<uint64_t>(key.arity) << 8)) *
+             0x9e3779b97f4a7c15ULL;
+
+        // Finalizer of MurmurHash3
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb93fe53cd5d9ULL;
+        h ^= h >> 33;
+
+        return static_cast<std::size_t>(h);
+    }
+};
+
+// Prints the key as INSTRUCTION_ARG1_ARG2, for logging
+std::ostream& operator<<(std::ostream&, const InstructionKey&);
+
+template <typename U>
+using InstructionKeyMap = std::unordered_map<InstructionKey, U, InstructionKeyHash>;
+
 /*
  * The BasicBlock Class describes the BasicBlock in the IR
  */
@@ -261,25 +586,30 @@ public:
         BB_END
     };
 
-    BasicBlock(BI, BBType);
+    BasicBlock(BI, BBType, ChunkedVector<Instruction>*);
 
     void AddPredecessor(BI);
     void AddSuccessor(BI);
-    void AddInstruction(II, Instruction*);
-    void AddInstructionFront(II, Instruction*);
+    void ReplacePredecessor(BI, BI);
+    void ReplaceSuccessor(BI, BI);
+    void AddInstruction(II);
+    void AddInstructionFront(II);
     void Seal() { is_sealed_ = true; }
     void Unseal() { is_sealed_ = false; }
     void MarkDead() { is_dead_ = true; }
     void EndBB() { is_ended_ = true; }
     void SetSelfValue(VI sv) { self_value_ = sv; }
 
-    const std::vector<BI> Predecessors() const;
-    const std::vector<BI> Successors() const;
+    const std::vector<BI>& Predecessors() const { return predecessors_; }
+    const std::vector<BI>& Successors() const { return successors_; }
+
+    const InstructionList& InstructionOrder() const { return instruction_order_; }
+    IteratorRange<InstructionList::reverse_iterator> ReverseInstructionOrder() const {
+        return {instruction_order_.rbegin(), instruction_order_.rend()};
+    }
 
-    const std::deque<II>& InstructionOrder() const { return instruction_order_; }
-    const std::unordered_map<II, Instruction*> Instructions() const { return instructions_; }
+    InstructionList& Instructions() { return instruction_order_; }
 
-    bool HasActiveInstructions() const;
     bool IsSealed() const { return is_sealed_; }
     bool HasEnded() const { return is_ended_; }
     bool IsDead() const { return is_dead_; }
@@ -300,13 +630,11 @@ private:
     // and join nodes.
     BBType type_;
 
-    // Vector of instructions contained inside this BasicBlock
-    std::unordered_map<II, Instruction*> instructions_;
-    
-    // We store a deque of the ordering of instructions contained by the BasicBlock
-    // The reason for keeping this a deque is that when creating Phi functions 
-    // lazily, we would like to add them to the beginning of the instruction_order
-    std::deque<II> instruction_order_;
+    // The instructions themselves are owned by the containing Function; a
+    // BasicBlock only links them up in order. Phis are created lazily and
+    // need to go to the beginning of the BB, and later passes insert and
+    // remove instructions anywhere, hence a linked list.
+    InstructionList instruction_order_;
 
     // Predecessors and Successors of the current BB
     std::vector<BI> predecessors_;
@@ -349,47 +677,62 @@ static const std::unordered_map<B, std::string> bra_to_str_ = {
  */
 class Function {
 public:
-    Function(const std::string&, VI, std::unordered_map<VI, Value*>*);
+    Function(const std::string&, VI, ValueTable*);
 
     const std::string& FunctionName() const { return func_name_; }
-    const Variable* GetVariable(const std::string&) const;
-    const std::unordered_map<BI, BasicBlock*> BasicBlocks() const;
-    const std::unordered_map<std::string, Variable*> Variables() const;
+    const Variable* GetVariable(SymbolId) const;
+    const std::unordered_map<BI, BasicBlock*>& BasicBlocks() const { return basic_block_map_; }
+    const std::unordered_map<SymbolId, Variable*>& Variables() const { return variable_map_; }
     const std::unordered_set<VI> GetKilledValues(BI) const;
-    const std::unordered_map<BI, BI>& DominatorTree() const;
-    const std::unordered_map<BI, BI>& DominanceFrontier() const;
     const std::unordered_map<II, std::unordered_set<II> >& LoadRelatedInsts() const;
     const std::vector<II>& CurrentLoadContributors() const;
 
-    std::vector<BI> PostOrderCFG();
-    std::vector<BI> ReversePostOrderCFG();
-    std::vector<BI> ExitBlocks();
+    const std::vector<BI>& ExitBlocks() const { return exit_blocks_; }
+
+    // Cached analyses. Each is computed on first use, and kept until the CFG
+    // is edited or a pass which does not preserve it has run.
+    const std::vector<BI>& PostOrderCFG();
+    const std::vector<BI>& ReversePostOrderCFG();
+    const DominatorTree& Dominators();
+    const DominatorTree& PostDominators();
+    const DominanceFrontier& DominanceFrontiers();
+    const DominanceFrontier& ReverseDominanceFrontiers();
+    const LoopInfo& Loops();
+
+    // Post order of the BBs from the entry, leaving out the back edges into
+    // loop heads, so that every BB comes after all its forward successors
+    std::vector<BI> ForwardPostOrder() const;
+
+    bool IsAnalysisValid(AnalysisKind kind) const { return (valid_analyses_ & kind) != 0; }
+    void InvalidateAnalyses(PreservedAnalyses);
 
     std::string ConvertValueToString(VI) const;
     
-    std::string HashInstruction(T, VI, VI) const;
-    std::string HashInstruction(T, VI) const;
-    std::string HashInstruction(T) const;
+    InstructionKey HashInstruction(T, VI, VI) const;
+    InstructionKey HashInstruction(T, VI) const;
+    InstructionKey HashInstruction(T) const;
 
     void SetLocalBase(VI val) { local_base_ = val; }
-    void AddVariable(const std::string&, Variable*);
+    void AddVariable(SymbolId, Variable*);
     void AddUsage(VI, II);
     void SetValueType(VI, V);
-    void WriteVariable(const std::string&, VI);
-    void WriteVariable(const std::string&, BI, VI);
+    void WriteVariable(SymbolId, VI);
+    void WriteVariable(SymbolId, BI, VI);
     void AddBBEdge(BI, BI);        // pred, succ
     void SealBB(BI);
     void UnsealAllBB();
     void SetCurrentBB(BI idx) { current_bb_ = idx; }
     void AddExitBlock(BI idx);
-    void MakeMove(const std::string&, VI);
+    void MakeMove(SymbolId, VI);
+    void RemoveInstruction(II);
     void ReplaceUse(VI, VI);
     void AddBackEdge(BI, BI);
-    void LoadFormal(const std::string&);
-    void InsertHash(const std::string&, VI);
+    void LoadFormal(SymbolId);
+    void InsertHash(const InstructionKey&, VI);
 
-    void ComputeDominatorTree();
-    void ComputeDominanceFrontier();
+    // Edits of the CFG. The cached CFG analyses are dropped.
+    BI SplitEdge(BI, BI);          // pred, succ
+    BI InsertPreheader(LI);
 
     // (instruction_idx, final_ins_idx)
     void AddArrContributor(II, II);
@@ -400,10 +743,11 @@ public:
 
     VI CreateMove(BI, VI, int);
 
-    int GetOffset(const std::string&) const;
+    int GetOffset(SymbolId) const;
     int ReduceCondition(RelationalOperator, VI, VI) const;
 
     Value* GetValue(VI) const;
+    ValueTable& Values() const { return *value_map_; }
 
     BI CreateBB(B);
     BI CurrentBBIdx() const { return current_bb_; }
@@ -417,8 +761,7 @@ public:
     VI CreateValue(V);
 
     VI GetCounter() const { return value_counter_; }
-    VI ReadVariable(const std::string&, BI);
-    VI ReadGlobal(const std::string&, BI);
+    VI ReadVariable(SymbolId, BI);
     VI LocalBase() const { return local_base_; }
 
     VI MakeInstruction(T);
@@ -429,9 +772,9 @@ public:
 
     VI SelfIdx() const { return self_idx_; }
     VI TryReduce(ArithmeticOperator, VI, VI);
-    VI GetLocationValue(const std::string&) const;
+    VI GetLocationValue(SymbolId) const;
     
-    VI GetHash(const std::string& hash_str) const;
+    VI GetHash(const InstructionKey&) const;
 
     Instruction* CurrentInstruction() const;
     Instruction* GetInstruction(II) const;
@@ -439,9 +782,9 @@ public:
     bool IsActive(II) const;
     bool HasEndedBB(BI idx) const;
 
-    bool IsVariableLocal(const std::string&) const;
-    bool IsVariableFormal(const std::string&) const;
-    bool IsFormalLoaded(const std::string&) const;
+    bool IsVariableLocal(SymbolId) const;
+    bool IsVariableFormal(SymbolId) const;
+    bool IsFormalLoaded(SymbolId) const;
 
     bool IsReducible(VI, VI) const;
     bool IsArithmetic(T) const;
@@ -451,7 +794,7 @@ public:
     bool IsPhi(II) const;
     bool IsEliminable(T) const;
 
-    bool HashExists(const std::string&) const;
+    bool HashExists(const InstructionKey&) const;
 
     bool IsKilled(BI) const;
 
@@ -476,7 +819,7 @@ private:
 
     // This points to the Global Value Map. This map is created only once, on
     // the heap and shared across all the functions for which IR is generated.
-    std::unordered_map<VI, Value*>* value_map_;
+    ValueTable* value_map_;
     
     // The following are data-structures used during SSA construction as described
     // by Braun et. al. 
@@ -486,19 +829,26 @@ private:
     // When there is a write, the current value is overwritten. If a value is not
     // found, we recursively search for its definition in the predecessors. Please
     // refer to SSA.cpp for more details.
-    std::unordered_map<std::string, std::unordered_map<BI, VI> > local_defs_;
+    //
+    // It is indexed as local_defs_[symbol][bb] and grown on demand; both
+    // SymbolIds and BIs are dense. Missing definitions are NOTFOUND.
+    std::vector<std::vector<VI> > local_defs_;
     // incomplete_phis_ are those which are lazily added before the sealing of
-    // the block is done. If phis are trivial, they are removed.
-    std::unordered_map<BI, std::unordered_map<std::string, II> > incomplete_phis_;
+    // the block is done. If phis are trivial, they are removed. They are
+    // completed in the order they were created.
+    std::unordered_map<BI, std::vector<std::pair<SymbolId, II> > > incomplete_phis_;
+    // Results of the Phis removed as trivial, and the values replacing them
+    std::unordered_map<VI, VI> removed_phis_;
 
     // Stores a map from BI -> pointer to BasicBlock object
     std::unordered_map<BI, BasicBlock*> basic_block_map_;
-    // Stores a map from variable name -> pointer to Variable Object
-    std::unordered_map<std::string, Variable*> variable_map_;
+    // Stores a map from variable -> pointer to Variable Object
+    std::unordered_map<SymbolId, Variable*> variable_map_;
     
-    // Keep a hash_map for storing the hash_string and the value associated with it.
-    // This is used for Common-Subexpression elimination (on-the-fly)
-    std::unordered_map<std::string, VI> hash_map_;
+    // Keep a hash_map for storing the key of an instruction and the value
+    // associated with it. This is used for Common-Subexpression elimination
+    // (on-the-fly)
+    InstructionKeyMap<VI> hash_map_;
     
     // This was an optimization I was experimenting with. What if, rather than
     // creating a new Value for each constant, we try and reuse those which 
@@ -508,17 +858,17 @@ private:
     // really figure out how to get around that problem.
     std::unordered_map<int, VI> constant_map_;
 
-    // Stores a map from II -> pointer to Instruction Object.
-    // A copy of this is present in the containing BB as well.
-    std::unordered_map<II, Instruction*> instruction_map_;
-
-    // Order of the instruction sequence
-    std::deque<II> instruction_order_;
+    // Owns every instruction of the function, indexed by II. Instructions
+    // are numbered from 1; slot 0 holds an inactive INS_NONE placeholder so
+    // that lookups are plain array loads.
+    ChunkedVector<Instruction> instructions_;
 
     // PostOrder CFG of the BBs
     std::vector<BI> postorder_cfg_;
     // Reverse PostOrder CFG of the BBs
     std::vector<BI> rev_postorder_cfg_;
+    // Which of the cached analyses are up to date, as AnalysisKind bits
+    PreservedAnalyses valid_analyses_;
     // All the exit blocks of the function. Reverse analyses start here.
     std::vector<BI> exit_blocks_;
 
@@ -535,14 +885,22 @@ private:
     // a context-sensitive and also a flow-sensitive analysis which I am not
     // quite sure how to incorporate with the Karlsruhe method. Keeping it 
     // as future work.
-    std::unordered_set<std::string> loaded_formals_;
+    std::unordered_set<SymbolId> loaded_formals_;
 
     // Stores the dominator tree of the graph. This is needed to fold the CFG
     // of the prorgam once "empty" blocks have been identified.
-    std::unordered_map<BI, BI> dominator_tree_;
+    DominatorTree dom_tree_;
+
+    // Stores the post-dominator tree, built on the reverse CFG
+    DominatorTree post_dom_tree_;
 
     // Stores dominance frontier
-    std::unordered_map<BI, BI> dominance_frontier_;
+    DominanceFrontier dom_frontier_;
+    // Stores the reverse dominance frontier, i.e. control dependences
+    DominanceFrontier reverse_dom_frontier_;
+
+    // Stores the loop nest forest
+    LoopInfo loop_info_;
 
     // Stores which BBs are killed
     std::unordered_map<BI, std::unordered_set<VI> > is_killed_;
@@ -562,21 +920,26 @@ private:
     BI bb_counter_;
 
     BI GetBBForInstruction(II);
-    BI Intersect(BI, BI);
 
-    VI ReadVariableRecursive(const std::string&, BI);
-    VI ReadGlobalRecursive(const std::string&, BI);
-    VI AddPhiOperands(const std::string&, VI);
-    VI SearchAndFillPhi(const std::string&, VI);
+    VI ReadVariableRecursive(SymbolId, BI);
+    VI AddPhiOperands(SymbolId, VI);
+    void AddPhiOperand(II, VI, BI);
+    VI LookupDef(SymbolId, BI) const;
     VI TryRemoveTrivialPhi(II);
+    VI Forwarded(VI) const;
     VI ResultForInstruction(II) const;
 
     II instruction_counter_;
     II MakePhi();
+    II NewInstruction(T);
 
     void AddBBPredecessor(BI, BI); // current, predecessor
     void AddBBSuccessor(BI, BI);   // current, successor
     void Visit(BI, std::unordered_set<BI>&);
+    void ComputeCFGOrder();
+    // Post order of the BBs from the entry, over every edge or only the
+    // forward ones
+    std::vector<BI> PostOrder(bool skip_back_edges) const;
 };
 
 } // namespace papyrus
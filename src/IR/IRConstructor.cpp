@@ -1,5 +1,7 @@
 #include "IRConstructor.h"
 
+#include "Analysis/AnalysisManager.h"
+
 using namespace papyrus;
 
 #define NOTFOUND -1
@@ -10,7 +12,8 @@ using ASTC = ASTConstructor;
 IRConstructor::IRConstructor(ASTC& astconst) :
     astconst_(astconst),
     value_counter_(0),
-    value_map_(new std::unordered_map<ValueIndex, Value*>()) {
+    value_map_(new ValueTable()),
+    analysis_manager_(new AnalysisManager(*this)) {
 
     DeclareIntrinsicFunctions();
 }
@@ -84,7 +87,7 @@ Function* IRC::GetFunction(const std::string& func_name) {
     return functions_.at(func_name);
 }
 
-std::vector<BI> IRC::PostOrderCFG(const std::string& func_name) const {
+const std::vector<BI>& IRC::PostOrderCFG(const std::string& func_name) const {
     return functions_.at(func_name)->PostOrderCFG();
 }
 
@@ -92,59 +95,54 @@ const std::unordered_map<std::string, Function*>& IRC::Functions() const {
     return functions_;
 }
 
-const std::map<std::string, Variable*>& IRC::Globals() const {
+const std::map<SymbolId, Variable*>& IRC::Globals() const {
     return global_variable_map_;
 }
 
-Variable* IRC::GetGlobal(const std::string& var_name) const {
+Variable* IRC::GetGlobal(SymbolId var_name) const {
     return global_variable_map_.at(var_name);
 }
 
-void IRC::AddGlobal(const std::string& var_name, Variable* var) {
+void IRC::AddGlobal(SymbolId var_name, Variable* var) {
     if (IsVariableGlobal(var_name)) {
-        LOG(ERROR) << "[IR] Attempt to redefine global variable " + var_name + " found.";
+        LOG(ERROR) << "[IR] Attempt to redefine global variable " + SymbolName(var_name) + " found.";
         exit(1);
     }
 
     global_variable_map_[var_name] = var;
 }
 
-void IRC::RemoveGlobal(const std::string& var_name) {
+void IRC::RemoveGlobal(SymbolId var_name) {
     global_variable_map_.erase(var_name);
 }
 
-int IRC::GlobalOffset(const std::string& var_name) const {
+int IRC::GlobalOffset(SymbolId var_name) const {
     return global_variable_map_.at(var_name)->Offset();
 }
 
-bool IRC::IsVariableGlobal(const std::string& var_name) const {
+bool IRC::IsVariableGlobal(SymbolId var_name) const {
     return global_variable_map_.find(var_name) != global_variable_map_.end();
 }
 
-VI IRC::GetLocationValue(const std::string& var_name) const {
+VI IRC::GetLocationValue(SymbolId var_name) const {
     return GetGlobal(var_name)->GetLocationIdx();
 }
 
 void IRC::DeclareGlobalBase() {
-    value_counter_++;
+    value_counter_ = value_map_->Create(V::VAL_GLOBALBASE);
 
-    global_base_ = new Value(V::VAL_GLOBALBASE);
+    global_base_ = value_map_->Get(value_counter_);
     global_base_idx_ = value_counter_;
-
-    value_map_->emplace(value_counter_, global_base_);
 }
 
 VI IRC::CreateValue(V vty) {
-    value_counter_++;
-
-    Value* val = new Value(vty);
-    value_map_->emplace(value_counter_, val);
+    value_counter_ = value_map_->Create(vty);
     
     return value_counter_;
 }
 
 Value* IRC::GetValue(VI value_idx) const {
-    return value_map_->at(value_idx);
+    return value_map_->Get(value_idx);
 }
 
 void IRC::BuildIR() {
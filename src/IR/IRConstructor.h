@@ -11,6 +11,7 @@
 namespace papyrus {
 
 class ASTConstructor;
+class AnalysisManager;
 
 using T  = Instruction::InstructionType;
 using V  = Value::ValueType;
@@ -31,37 +32,39 @@ public:
     void AddFunction(const std::string&, Function*);
     void SetCurrentFunction(Function* f) { current_function_ = f; }
     void ClearCurrentFunction() { current_function_ = nullptr; }
-    void AddGlobal(const std::string&, Variable*);
-    void RemoveGlobal(const std::string&);
+    void AddGlobal(SymbolId, Variable*);
+    void RemoveGlobal(SymbolId);
     void SetCounter(VI idx) { value_counter_ = idx; }
     void DeclareGlobalBase();
 
     ASTConstructor& ASTConst() { return astconst_; }
+    AnalysisManager& Analyses() const { return *analysis_manager_; }
 
     const std::unordered_map<std::string, Function*>& Functions() const;
-    const std::map<std::string, Variable*>& Globals() const;
-    std::vector<BI> PostOrderCFG(const std::string&) const;
+    const std::map<SymbolId, Variable*>& Globals() const;
+    const std::vector<BI>& PostOrderCFG(const std::string&) const;
 
-    Variable* GetGlobal(const std::string&) const;
+    Variable* GetGlobal(SymbolId) const;
     Value* GetValue(VI) const;
 
     bool IsExistFunction(const std::string&) const;
-    bool IsVariableGlobal(const std::string&) const;
+    bool IsVariableGlobal(SymbolId) const;
     bool IsIntrinsic(const std::string&) const;
 
     inline Function* CurrentFunction() const { return current_function_; }
 
     Function* GetFunction(const std::string&);
 
-    int GlobalOffset(const std::string&) const;
+    int GlobalOffset(SymbolId) const;
 
     VI ValueCounter() const { return value_counter_; }
     VI CreateConstant(int);
     VI GlobalBase() const { return global_base_idx_; }
-    VI GetLocationValue(const std::string&) const;
+    VI GetLocationValue(SymbolId) const;
     VI CreateValue(V);
 
-    std::unordered_map<VI, Value*>* ValMap() const { return value_map_; }
+    ValueTable* ValMap() const { return value_map_; }
+    ValueTable& Values() const { return *value_map_; }
 
     T ConvertOperation(ArithmeticOperator);
     T ConvertOperation(RelationalOperator);
@@ -79,11 +82,13 @@ private:
 
     // Global variables map. This is used to store variables which are then 
     // used to determine their offsets from the global base.
-    std::map<std::string, Variable*> global_variable_map_;
+    std::map<SymbolId, Variable*> global_variable_map_;
     // Stores a map from function_name -> pointer to Function object
     std::unordered_map<std::string, Function*> functions_;
-    // Global Value map
-    std::unordered_map<VI, Value*>* value_map_;
+    // Global Value table
+    ValueTable* value_map_;
+    // Cached analyses of the module, created along with it
+    AnalysisManager* analysis_manager_;
 
     // Pointer to an object of the current function
     Function* current_function_;
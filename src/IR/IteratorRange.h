@@ -0,0 +1,38 @@
+#ifndef PAPYRUS_ITERATORRANGE_H
+#define PAPYRUS_ITERATORRANGE_H
+
+#include <cstddef>
+#include <iterator>
+
+namespace papyrus {
+
+/*
+ * A pair of iterators which can be used in a range-based for loop. It is a
+ * read-only view into a container owned by someone else, so handing one out
+ * neither copies nor allocates. The container must outlive the range.
+ */
+template <typename It>
+class IteratorRange {
+public:
+    IteratorRange(It begin, It end) : begin_(begin), end_(end) {}
+
+    It begin() const { return begin_; }
+    It end() const { return end_; }
+
+    bool empty() const { return begin_ == end_; }
+    std::size_t size() const { return std::distance(begin_, end_); }
+
+private:
+    It begin_;
+    It end_;
+};
+
+// View of a container from back to front
+template <typename C>
+IteratorRange<typename C::const_reverse_iterator> Reversed(const C& container) {
+    return {container.crbegin(), container.crend()};
+}
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_ITERATORRANGE_H */
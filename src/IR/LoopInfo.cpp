@@ -0,0 +1,146 @@
+#include "LoopInfo.h"
+#include "IR.h"
+
+#include <algorithm>
+
+using namespace papyrus;
+
+void LoopInfo::Compute(Function* fn, const DominatorTree& dom_tree) {
+    loops_.clear();
+    top_level_.clear();
+    innermost_.assign(dom_tree.NumBBs(), NO_LOOP);
+
+    const auto& rpo = dom_tree.ReversePostOrder();
+    std::vector<BI> worklist;
+
+    // A header dominates every BB of its loop, and so comes before them in
+    // RPO. Going backwards, nested loops are found first.
+    for (auto it = rpo.rbegin(); it != rpo.rend(); it++) {
+        BI header = *it;
+
+        worklist.clear();
+        for (auto pred: fn->GetBB(header)->Predecessors()) {
+            if (dom_tree.Dominates(header, pred)) {
+                worklist.push_back(pred);
+            }
+        }
+
+        if (worklist.empty()) {
+            continue;
+        }
+
+        LI loop_idx = loops_.size();
+        loops_.emplace_back();
+
+        Loop& loop   = loops_.back();
+        loop.header  = header;
+        loop.parent  = NO_LOOP;
+        loop.depth   = 0;
+        loop.latches = worklist;
+        std::sort(loop.latches.begin(), loop.latches.end());
+
+        innermost_[header] = loop_idx;
+
+        while (!worklist.empty()) {
+            BI bb_idx = worklist.back();
+            worklist.pop_back();
+
+            LI inner = innermost_[bb_idx];
+            if (inner == NO_LOOP) {
+                innermost_[bb_idx] = loop_idx;
+                for (auto pred: fn->GetBB(bb_idx)->Predecessors()) {
+                    if (dom_tree.Dominates(header, pred)) {
+                        worklist.push_back(pred);
+                    }
+                }
+                continue;
+            }
+
+            // The BB is already part of this loop, or of a nested loop. In
+            // the latter case, the outermost loop found so far is nested
+            // right inside this one.
+            while (loops_[inner].parent != NO_LOOP) {
+                inner = loops_[inner].parent;
+            }
+
+            if (inner == loop_idx) {
+                continue;
+            }
+
+            loops_[inner].parent = loop_idx;
+
+            // Carry on from the entries into the nested loop
+            BI inner_header = loops_[inner].header;
+            for (auto pred: fn->GetBB(inner_header)->Predecessors()) {
+                if (!dom_tree.Dominates(inner_header, pred) &&
+                    dom_tree.Dominates(header, pred)) {
+                    worklist.push_back(pred);
+                }
+            }
+        }
+    }
+
+    // Parents are always found after their children
+    for (LI loop_idx = static_cast<LI>(loops_.size()) - 1; loop_idx >= 0; loop_idx--) {
+        Loop& loop = loops_[loop_idx];
+
+        if (loop.parent == NO_LOOP) {
+            loop.depth = 1;
+            top_level_.push_back(loop_idx);
+        } else {
+            loop.depth = loops_[loop.parent].depth + 1;
+            loops_[loop.parent].children.push_back(loop_idx);
+        }
+    }
+
+    auto by_header = [this, &dom_tree](LI l1, LI l2) {
+        return dom_tree.RPONumber(loops_[l1].header) < dom_tree.RPONumber(loops_[l2].header);
+    };
+
+    std::sort(top_level_.begin(), top_level_.end(), by_header);
+    for (auto& loop: loops_) {
+        std::sort(loop.children.begin(), loop.children.end(), by_header);
+    }
+
+    // Every BB belongs to its innermost loop and all the loops around it
+    for (std::size_t bb_idx = 0; bb_idx < innermost_.size(); bb_idx++) {
+        for (LI loop_idx = innermost_[bb_idx]; loop_idx != NO_LOOP; loop_idx = loops_[loop_idx].parent) {
+            loops_[loop_idx].blocks.push_back(bb_idx);
+        }
+    }
+
+    for (auto& loop: loops_) {
+        for (auto bb_idx: loop.blocks) {
+            bool is_exiting = false;
+
+            for (auto succ: fn->GetBB(bb_idx)->Successors()) {
+                if (!std::binary_search(loop.blocks.begin(), loop.blocks.end(), succ)) {
+                    is_exiting = true;
+                    loop.exits.push_back(succ);
+                }
+            }
+
+            if (is_exiting) {
+                loop.exiting.push_back(bb_idx);
+            }
+        }
+
+        std::sort(loop.exits.begin(), loop.exits.end());
+        loop.exits.erase(std::unique(loop.exits.begin(), loop.exits.end()), loop.exits.end());
+    }
+}
+
+bool LoopInfo::Contains(LI loop_idx, BI bb_idx) const {
+    uint32_t depth = loops_[loop_idx].depth;
+
+    for (LI inner = LoopFor(bb_idx); inner != NO_LOOP; inner = loops_[inner].parent) {
+        if (inner == loop_idx) {
+            return true;
+        }
+        if (loops_[inner].depth <= depth) {
+            return false;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,92 @@
+#ifndef PAPYRUS_LOOPINFO_H
+#define PAPYRUS_LOOPINFO_H
+
+#include "DominatorTree.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace papyrus {
+
+using LI = int; // LoopIndex
+
+// Loops are numbered from 0
+constexpr LI NO_LOOP = -1;
+
+/*
+ * A natural loop: the header, and every BB which can reach a latch (a BB with
+ * a back edge to the header) without going through the header. All the BB
+ * lists are sorted.
+ */
+struct Loop {
+    BI header;
+
+    // Enclosing loop, NO_LOOP for outermost loops
+    LI parent;
+    // Loops immediately nested in this one
+    std::vector<LI> children;
+    // 1 for outermost loops
+    uint32_t depth;
+
+    // BBs with a back edge to the header
+    std::vector<BI> latches;
+    // Every BB of the loop, including the header and nested loops
+    std::vector<BI> blocks;
+    // BBs of the loop with a successor outside of it
+    std::vector<BI> exiting;
+    // BBs outside of the loop with a predecessor inside of it
+    std::vector<BI> exits;
+};
+
+/*
+ * LoopInfo is the loop nest forest of a Function, built from its dominator
+ * tree: an edge to a BB which dominates its source is a back edge, and each
+ * header with back edges makes a loop. Headers are visited inner loops first,
+ * so that the body of a loop is discovered by walking up from its latches and
+ * skipping over the nested loops which have already been found.
+ *
+ * Unlike the BB_LOOPHEAD type of a BB, this does not depend on how the CFG
+ * was built, and stays correct after passes edit the CFG and recompute it.
+ */
+class LoopInfo {
+public:
+    void Compute(Function*, const DominatorTree&);
+
+    // Nested loops come before the loops containing them
+    const std::vector<Loop>& Loops() const { return loops_; }
+    const Loop& GetLoop(LI loop_idx) const { return loops_[loop_idx]; }
+
+    // Outermost loops, in reverse postorder of their headers
+    const std::vector<LI>& TopLevelLoops() const { return top_level_; }
+
+    // Innermost loop containing the BB, NO_LOOP if none
+    LI LoopFor(BI bb_idx) const {
+        return (bb_idx >= 0 && static_cast<std::size_t>(bb_idx) < innermost_.size()) ?
+               innermost_[bb_idx] : NO_LOOP;
+    }
+
+    // Number of loops containing the BB, 0 outside of loops
+    uint32_t LoopDepth(BI bb_idx) const {
+        LI loop_idx = LoopFor(bb_idx);
+        return loop_idx == NO_LOOP ? 0 : loops_[loop_idx].depth;
+    }
+
+    bool IsHeader(BI bb_idx) const {
+        LI loop_idx = LoopFor(bb_idx);
+        return loop_idx != NO_LOOP && loops_[loop_idx].header == bb_idx;
+    }
+
+    bool Contains(LI, BI) const;
+
+private:
+    std::vector<Loop> loops_;
+    std::vector<LI> top_level_;
+
+    // Indexed by BI
+    std::vector<LI> innermost_;
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_LOOPINFO_H */
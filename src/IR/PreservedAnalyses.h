@@ -0,0 +1,42 @@
+#ifndef PAPYRUS_PRESERVEDANALYSES_H
+#define PAPYRUS_PRESERVEDANALYSES_H
+
+#include <cstdint>
+
+namespace papyrus {
+
+/*
+ * Every analysis which is cached, one bit each. A pass declares the set of
+ * analyses it keeps valid as a PreservedAnalyses mask, and the cached results
+ * of all the others are dropped once it has run.
+ */
+enum AnalysisKind : uint32_t {
+    // Per function
+    ANALYSIS_CFG_ORDER                  = 1u << 0,
+    ANALYSIS_DOMINATORS                 = 1u << 1,
+    ANALYSIS_POST_DOMINATORS            = 1u << 2,
+    ANALYSIS_DOMINANCE_FRONTIER         = 1u << 3,
+    ANALYSIS_REVERSE_DOMINANCE_FRONTIER = 1u << 4,
+    ANALYSIS_LOOPS                      = 1u << 5,
+
+    // Per module
+    ANALYSIS_CALL_GRAPH                 = 1u << 16,
+};
+
+using PreservedAnalyses = uint32_t;
+
+constexpr PreservedAnalyses PRESERVE_NONE = 0;
+constexpr PreservedAnalyses PRESERVE_ALL  = ~0u;
+
+// Analyses computed from the shape of the CFG alone. Passes which only add,
+// remove or rewrite instructions, without touching branches, keep them.
+constexpr PreservedAnalyses PRESERVE_CFG = ANALYSIS_CFG_ORDER |
+                                           ANALYSIS_DOMINATORS |
+                                           ANALYSIS_POST_DOMINATORS |
+                                           ANALYSIS_DOMINANCE_FRONTIER |
+                                           ANALYSIS_REVERSE_DOMINANCE_FRONTIER |
+                                           ANALYSIS_LOOPS;
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_PRESERVEDANALYSES_H */
@@ -20,74 +20,126 @@ void Instruction::ReplaceUse(VI replacee_idx, VI replacer_idx) {
     std::replace(operands_.begin(), operands_.end(), replacee_idx, replacer_idx);
 }
 
-void Value::RemoveUse(II ins_idx) {
-    uses_.erase(std::remove(uses_.begin(), uses_.end(), ins_idx), uses_.end());
-}
-
 bool Function::IsPhi(II ins_idx) const {
-    return instruction_map_.at(ins_idx)->IsPhi();
+    return GetInstruction(ins_idx)->IsPhi();
 }
 
 /* Remove trivial Phis. There are multiple reasons why this could happen. One
  * of which is if there are same values flowing into the BB leading to a Phi
  * with the same operands.
+ *
+ * As in the paper, the Phis using a removed Phi are tried again, since they
+ * may have become trivial in turn. They are kept on a worklist rather than
+ * recursed into, as the chain can be as long as the nesting of loops. A Phi
+ * which is still being filled has fewer operands than its BB predecessors,
+ * and is tried once it is complete.
+ *
+ * A removed Phi may still be the definition recorded in local_defs_ for
+ * blocks other than its own. Its replacement is remembered, and LookupDef()
+ * follows it.
  */
 VI Function::TryRemoveTrivialPhi(II phi_ins) {
-    auto same = NOTFOUND;
-    auto ins  = GetInstruction(phi_ins);
-
-    if (!ins->IsActive()) {
+    if (!IsActive(phi_ins)) {
         return NOTFOUND;
     }
 
-    auto result = ins->Result();
+    VI phi_result = GetInstruction(phi_ins)->Result();
+
+    std::vector<II> worklist = {phi_ins};
+    while (!worklist.empty()) {
+        auto ins = GetInstruction(worklist.back());
+        worklist.pop_back();
 
-    for (auto op: ins->Operands()) {
-        if (op == same || op == result) {
+        if (!ins->IsActive()) {
             continue;
         }
-        if (same != NOTFOUND) {
-            // this was earlier phi_ins
-            return result;
+
+        auto same   = NOTFOUND;
+        auto result = ins->Result();
+        bool is_trivial = true;
+
+        for (auto op: ins->Operands()) {
+            if (op == same || op == result) {
+                continue;
+            }
+            if (same != NOTFOUND) {
+                is_trivial = false;
+                break;
+            }
+            same = op;
         }
-        same = op;
-    }
 
-    // Check if we can remove generation of a value when it is not
-    // defined.
-    if (same == NOTFOUND) {
-        same = CreateValue(V::VAL_ANY);
-    }
+        if (!is_trivial) {
+            continue;
+        }
 
-    ReplaceUse(result, same);
-    ins->MakeInactive();
+        // Check if we can remove generation of a value when it is not
+        // defined.
+        if (same == NOTFOUND) {
+            same = CreateValue(V::VAL_ANY);
+        }
 
-    // Replace instance in local_defs_
-    auto res = GetValue(result);
-    auto ident = res->Identifier();
-    local_defs_[ident][ins->ContainingBB()] = same;
+        for (auto use_idx: Values().Uses(result)) {
+            auto user = GetInstruction(Values().GetUse(use_idx).user);
+            if (user != ins && user->IsActive() && user->IsPhi() &&
+                user->Operands().size() == GetBB(user->ContainingBB())->Predecessors().size()) {
+                worklist.push_back(user->Index());
+            }
+        }
+
+        ReplaceUse(result, same);
+        RemoveInstruction(ins->Index());
+        removed_phis_[result] = same;
 
-    for (auto use_idx: res->GetUsers()) {
-        TryRemoveTrivialPhi(use_idx);
+        // Replace instance in local_defs_
+        // The result of a Phi created while reading a variable is only tagged
+        // with the variable once the read completes, so it may not have one yet.
+        auto res = GetValue(result);
+        if (res->GetSymbol() != NO_SYMBOL) {
+            WriteVariable(res->GetSymbol(), ins->ContainingBB(), same);
+        }
     }
 
-    return same;
+    return Forwarded(phi_result);
+}
+
+// The value standing in for a Phi removed as trivial, or the value itself
+VI Function::Forwarded(VI val_idx) const {
+    auto it = removed_phis_.find(val_idx);
+    while (it != removed_phis_.end()) {
+        val_idx = it->second;
+        it = removed_phis_.find(val_idx);
+    }
+
+    return val_idx;
 }
 
 /*
- * Utility function to replace all uses of a value with a new one
+ * Utility function to replace all uses of a value with a new one. Each use
+ * is moved over to the new value as is, so this is linear in the number of
+ * uses.
  */
 void Function::ReplaceUse(VI old_idx, VI new_idx) {
-    auto old_val = GetValue(old_idx);
-    auto new_val = GetValue(new_idx);
-    auto all_uses = old_val->GetUsers();
-
-    for (auto use_idx: all_uses) {
-        auto ins = GetInstruction(use_idx);
-        ins->ReplaceUse(old_idx, new_idx);
-        new_val->AddUsage(use_idx);
-        old_val->RemoveUse(use_idx);
+    if (old_idx == new_idx) {
+        return;
     }
+
+    ValueTable& values = Values();
+    auto uses = values.Uses(old_idx);
+    for (auto it = uses.begin(); it != uses.end(); ) {
+        // Step past the use before it is moved over to the other list
+        UI use_idx = *it++;
+
+        GetInstruction(values.GetUse(use_idx).user)->ReplaceUse(old_idx, new_idx);
+        values.MoveUse(use_idx, new_idx);
+    }
+}
+
+// Phi operands are uses like any other, so that replacing a value reaches
+// the Phis which merge it as well
+void Function::AddPhiOperand(II phi_ins, VI val_idx, BI pred) {
+    GetInstruction(phi_ins)->AddOperand(val_idx, pred);
+    AddUsage(val_idx, phi_ins);
 }
 
 /*
@@ -96,16 +148,15 @@ void Function::ReplaceUse(VI old_idx, VI new_idx) {
  *
  * Eventually, we then try and remove trivial Phis.
  */
-VI Function::AddPhiOperands(const std::string& var_name, II phi_ins) {
+VI Function::AddPhiOperands(SymbolId var_name, II phi_ins) {
     if (!IsActive(phi_ins)) {
         return NOTFOUND;
     }
 
     auto bb = GetBB(GetBBForInstruction(phi_ins));
-    auto ins = GetInstruction(phi_ins);
 
     for (auto pred: bb->Predecessors()) {
-        ins->AddOperand(ReadVariable(var_name, pred), pred);
+        AddPhiOperand(phi_ins, ReadVariable(var_name, pred), pred);
     }
 
     return TryRemoveTrivialPhi(phi_ins);
@@ -127,39 +178,114 @@ VI Function::AddPhiOperands(const std::string& var_name, II phi_ins) {
  *
  * Finally, we write the result generated as a result of either of the above
  * operations and use it as the definition of the variable for that block.
+ *
+ * In cases 2 and 3 the variable is read in the predecessors, which in the
+ * paper is a recursive call. A long chain of blocks without a definition
+ * makes for a recursion as deep as the chain, so the reads are kept on an
+ * explicit stack of frames instead. The frames are visited in the order of
+ * the recursive calls, so the Phis and values created are the same.
  */
-VI Function::ReadVariableRecursive(const std::string& var_name, BI bb_idx) {
-    BI cur_bb_idx = CurrentBBIdx();
-    VI result  = NOTFOUND;
-    BI phi_ins = NOTFOUND;
-    auto bb    = GetBB(bb_idx);
-
-    if (!bb->IsSealed()) {
-        SetCurrentBB(bb_idx);
-        phi_ins = MakePhi();
-        result = ResultForInstruction(phi_ins);
-        incomplete_phis_[bb_idx][var_name] = phi_ins;
-    } else if (bb->Predecessors().size() == 1) {
-        result = ReadVariable(var_name, bb->Predecessors()[0]);
-    } else if (bb_idx == 1 && bb->IsSealed()) {
-        // Here, we handle the case when we end up reaching the entry node while 
-        // searching for a def for a variable. In that case, we will assume that
-        // variables which are unverified will be initialized to 0 or VAR
-        // result = CreateConstant(0);
-        result = CreateValue(V::VAL_VAR);
+VI Function::ReadVariableRecursive(SymbolId var_name, BI bb_idx) {
+    struct Frame {
+        BI bb_idx;
+        // Current BB when the read in this block started
+        BI saved_bb_idx;
+        // The Phi of case 3, NOTFOUND otherwise
+        II phi_ins;
+        // Predecessors read so far
+        std::size_t next_pred;
+        bool done;
+        VI result;
+    };
+
+    std::vector<Frame> frames;
+
+    // Case 1 and the entry block are over right away, cases 2 and 3 go on
+    // in the loop below
+    auto enter = [&](BI idx) {
+        Frame frame = {idx, CurrentBBIdx(), NOTFOUND, 0, false, NOTFOUND};
+        auto bb = GetBB(idx);
+
+        if (!bb->IsSealed()) {
+            SetCurrentBB(idx);
+            auto phi_ins = MakePhi();
+            frame.result = ResultForInstruction(phi_ins);
+            frame.done = true;
+            incomplete_phis_[idx].push_back({var_name, phi_ins});
+        } else if (bb->Predecessors().size() == 1) {
+            // Read below
+        } else if (idx == 1) {
+            // Here, we handle the case when we end up reaching the entry node while 
+            // searching for a def for a variable. In that case, we will assume that
+            // variables which are unverified will be initialized to 0 or VAR
+            // result = CreateConstant(0);
+            frame.result = CreateValue(V::VAL_VAR);
+            frame.done = true;
+            GetValue(frame.result)->SetIdentifier(var_name);
+        } else {
+            SetCurrentBB(idx);
+            frame.phi_ins = MakePhi();
+            WriteVariable(var_name, idx, ResultForInstruction(frame.phi_ins));
+        }
+
+        frames.push_back(frame);
+    };
+
+    enter(bb_idx);
+
+    VI result = NOTFOUND;
+    while (!frames.empty()) {
+        Frame& frame = frames.back();
+
+        if (!frame.done) {
+            const auto& preds = GetBB(frame.bb_idx)->Predecessors();
+            bool reading = false;
+
+            while (frame.next_pred < preds.size() && !reading) {
+                auto pred = preds[frame.next_pred++];
+
+                VI def = LookupDef(var_name, pred);
+                if (def == NOTFOUND) {
+                    // The definition comes back once the read in pred is over
+                    reading = true;
+                } else if (frame.phi_ins == NOTFOUND) {
+                    frame.result = def;
+                } else {
+                    AddPhiOperand(frame.phi_ins, def, pred);
+                }
+            }
+
+            if (reading) {
+                // Invalidates frame
+                enter(preds[frame.next_pred - 1]);
+                continue;
+            }
+
+            if (frame.phi_ins != NOTFOUND) {
+                frame.result = TryRemoveTrivialPhi(frame.phi_ins);
+            }
+        }
+
+        // Add identifier for phi / constant
+        result = frame.result;
         GetValue(result)->SetIdentifier(var_name);
-    } else {
-        SetCurrentBB(bb_idx);
-        phi_ins = MakePhi();
-        result = ResultForInstruction(phi_ins);
-        WriteVariable(var_name, bb_idx, result);
-        result = AddPhiOperands(var_name, phi_ins);
+        SetCurrentBB(frame.saved_bb_idx);
+        WriteVariable(var_name, frame.bb_idx, result);
+
+        frames.pop_back();
+
+        // Hand the definition over to the read it was made for
+        if (!frames.empty()) {
+            Frame& parent = frames.back();
+            if (parent.phi_ins == NOTFOUND) {
+                parent.result = result;
+            } else {
+                auto pred = GetBB(parent.bb_idx)->Predecessors()[parent.next_pred - 1];
+                AddPhiOperand(parent.phi_ins, result, pred);
+            }
+        }
     }
 
-    // Add identifier for phi / constant
-    GetValue(result)->SetIdentifier(var_name);
-    SetCurrentBB(cur_bb_idx);
-    WriteVariable(var_name, bb_idx, result);
     return result;
 }
 
@@ -169,24 +295,47 @@ VI Function::ReadVariableRecursive(const std::string& var_name, BI bb_idx) {
  * found in the current block, ReadVariableRecursive() is called to pull
  * up definitions from its predecessors.
  */
-VI Function::ReadVariable(const std::string& var_name, BI bb_idx) {
-    if (local_defs_[var_name].find(bb_idx) != local_defs_[var_name].end()) {
-        return local_defs_[var_name][bb_idx];
+VI Function::ReadVariable(SymbolId var_name, BI bb_idx) {
+    VI def = LookupDef(var_name, bb_idx);
+    if (def != NOTFOUND) {
+        return def;
     } else {
         return ReadVariableRecursive(var_name, bb_idx);
     }
 }
 
+VI Function::LookupDef(SymbolId var_name, BI bb_idx) const {
+    if (var_name >= local_defs_.size()) {
+        return NOTFOUND;
+    }
+
+    auto& defs = local_defs_[var_name];
+    if (static_cast<std::size_t>(bb_idx) >= defs.size() || defs[bb_idx] == NOTFOUND) {
+        return NOTFOUND;
+    }
+
+    return Forwarded(defs[bb_idx]);
+}
+
 /*
  * The WriteVariable operation is pretty straightforward. We rewrite the
  * current definition of the variable in the block to be the new value
  */
-void Function::WriteVariable(const std::string& var_name, VI val_idx) {
+void Function::WriteVariable(SymbolId var_name, VI val_idx) {
     WriteVariable(var_name, CurrentBBIdx(), val_idx);
 }
 
-void Function::WriteVariable(const std::string& var_name, BI bb_idx, VI val_idx) {
-    local_defs_[var_name][bb_idx] = val_idx;
+void Function::WriteVariable(SymbolId var_name, BI bb_idx, VI val_idx) {
+    if (var_name >= local_defs_.size()) {
+        local_defs_.resize(var_name + 1);
+    }
+
+    auto& defs = local_defs_[var_name];
+    if (static_cast<std::size_t>(bb_idx) >= defs.size()) {
+        defs.resize(std::max<std::size_t>(bb_idx + 1, bb_counter_ + 1), NOTFOUND);
+    }
+
+    defs[bb_idx] = val_idx;
 }
 
 /*
@@ -198,46 +347,23 @@ void Function::WriteVariable(const std::string& var_name, BI bb_idx, VI val_idx)
  * 
  * Later, we also remove Phis which might have become trivial.
  *
- * Finally, we redirect the use of all values involved in the Phi as operands
- * and use the Phi instead
+ * Reads of the variable in this BB made while it was unsealed already got
+ * the incomplete Phi, so no other use has to be redirected to it. An operand
+ * of the Phi, a constant most of all, may well be used in the BB as some
+ * other variable or as a literal.
  */
 void Function::SealBB(BI bb_idx) {
     SetCurrentBB(bb_idx);
 
-    Instruction *ins, *user_ins;
-    Value* val;
-
     if (incomplete_phis_.find(bb_idx) != incomplete_phis_.end()) {
-        for (auto var_map: incomplete_phis_.at(bb_idx)) {
-            auto var_name = var_map.first;
-            auto ins_idx  = var_map.second;
+        // Completing a Phi may lazily create further Phis, so the vector is
+        // indexed rather than iterated.
+        auto& phis = incomplete_phis_.at(bb_idx);
+        for (std::size_t i = 0; i < phis.size(); i++) {
+            auto var_name = phis[i].first;
+            auto ins_idx  = phis[i].second;
 
             AddPhiOperands(var_name, ins_idx);
-
-            ins = GetInstruction(ins_idx);
-            if (!ins->IsActive()) {
-                // This Phi has become inactive; which means we should make sure
-                // that all instructions which use its result are made inactive.
-                continue;
-            }
-
-            auto result = ins->Result();
-            for (auto val_idx: ins->Operands()) {
-                // Find the users of the particular value
-                // and redirect their use to be that of the Phi instead
-                //
-                // NOTE: This is to be done for values in the block
-                // under consideration since otherwise, it could
-                // potentially lead to other issues.
-                val = GetValue(val_idx);
-                for (auto user: val->GetUsers()) {
-                    user_ins = GetInstruction(user);
-                    if (user_ins->ContainingBB() == bb_idx) {
-                        GetInstruction(user)->ReplaceUse(val_idx, result);
-                        val->RemoveUse(user);
-                    }
-                }
-            }
         }
     }
 
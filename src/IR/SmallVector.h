@@ -0,0 +1,117 @@
+#ifndef PAPYRUS_SMALLVECTOR_H
+#define PAPYRUS_SMALLVECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace papyrus {
+
+/*
+ * A vector of trivially copyable elements which keeps up to N of them inside
+ * the object itself, and only goes to the heap once it grows past that. Most
+ * instructions have at most a couple of operands, so they never allocate.
+ */
+template <typename T, std::size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SmallVector only holds trivially copyable elements");
+
+public:
+    SmallVector() : size_(0), capacity_(N) {}
+
+    SmallVector(const SmallVector& other) : size_(0), capacity_(N) {
+        *this = other;
+    }
+
+    SmallVector(SmallVector&& other) noexcept : size_(other.size_), capacity_(other.capacity_) {
+        if (other.IsInline()) {
+            std::memcpy(inline_, other.inline_, size_ * sizeof(T));
+        } else {
+            heap_ = other.heap_;
+            other.size_ = 0;
+            other.capacity_ = N;
+        }
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            size_ = 0;
+            Reserve(other.size_);
+            std::memcpy(data(), other.data(), other.size_ * sizeof(T));
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&&) = delete;
+
+    ~SmallVector() {
+        if (!IsInline()) {
+            delete[] heap_;
+        }
+    }
+
+    void push_back(T elem) {
+        if (size_ == capacity_) {
+            Reserve(2 * capacity_);
+        }
+        data()[size_++] = elem;
+    }
+
+    T* data() { return IsInline() ? inline_ : heap_; }
+    const T* data() const { return IsInline() ? inline_ : heap_; }
+
+    T* begin() { return data(); }
+    T* end() { return data() + size_; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size_; }
+
+    T& operator[](std::size_t idx) { return data()[idx]; }
+    const T& operator[](std::size_t idx) const { return data()[idx]; }
+
+    const T& at(std::size_t idx) const {
+        if (idx >= size_) {
+            throw std::out_of_range("SmallVector::at");
+        }
+        return data()[idx];
+    }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Heap bytes held, 0 while the elements fit inline
+    std::size_t BytesAllocated() const { return IsInline() ? 0 : capacity_ * sizeof(T); }
+
+private:
+    uint32_t size_;
+    uint32_t capacity_;
+
+    union {
+        T inline_[N];
+        T* heap_;
+    };
+
+    bool IsInline() const { return capacity_ == N; }
+
+    void Reserve(std::size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+
+        T* grown = new T[capacity];
+        std::memcpy(grown, data(), size_ * sizeof(T));
+        if (!IsInline()) {
+            delete[] heap_;
+        }
+
+        heap_ = grown;
+        capacity_ = static_cast<uint32_t>(capacity);
+    }
+};
+
+} // namespace papyrus
+
+#endif /* PAPYRUS_SMALLVECTOR_H */
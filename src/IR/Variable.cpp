@@ -2,7 +2,7 @@
 
 using namespace papyrus;
 
-Symbol::Symbol(const std::string& identifier, const std::vector<int>& dimensions, bool if_array, bool is_global, bool is_formal) :
+Symbol::Symbol(SymbolId identifier, const std::vector<int>& dimensions, bool if_array, bool is_global, bool is_formal) :
     identifier_(identifier),
     dimensions_(dimensions),
     if_array_(if_array),
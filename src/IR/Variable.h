@@ -2,6 +2,7 @@
 #define PAPYRUS_VARIABLE_H
 
 #include "Papyrus/Logger/Logger.h"
+#include "FrontEnd/Interner.h"
 
 #include <vector>
 
@@ -17,17 +18,18 @@ using VI = int;
  */
 class Symbol {
 public:
-    Symbol(const std::string&, const std::vector<int>&, bool, bool, bool);
+    Symbol(SymbolId, const std::vector<int>&, bool, bool, bool);
 
-    const std::string& IdentifierName() const { return identifier_; }
+    SymbolId GetSymbol() const { return identifier_; }
+    const std::string& IdentifierName() const { return SymbolName(identifier_); }
     const std::vector<int>& GetDimensions() const { return dimensions_; }
     bool IsArray() const { return if_array_; }
     bool IsGlobal() const { return is_global_; }
     bool IsFormal() const { return is_formal_; }
     
 private:
-    // Identifier for the Symbol
-    std::string identifier_;
+    // Interned identifier for the Symbol
+    SymbolId identifier_;
     // If array, store dimensions
     std::vector<int> dimensions_;
 
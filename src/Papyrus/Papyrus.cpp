@@ -6,74 +6,151 @@
 
 #include "IR/IR.h"
 #include "IR/IRConstructor.h"
+#include "IR/FusedParser.h"
 
-#include "Analysis/ArrayLSRemover.h"
-#include "Analysis/DCE.h"
+#include "Analysis/PassManager.h"
 
-#include "RegAlloc/IGBuilder.h"
 #include "RegAlloc/RegAlloc.h"
 
 #include "Utils.h"
 
 #include "Visualizer/Visualizer.h"
 
+#include <sstream>
+
 using namespace papyrus;
 
 structlog LOGCFG = {};
 
+// The N of --option=N
+static int ParseJobs(const std::string& arg) {
+    std::string jobs = arg.substr(arg.find('=') + 1);
+    if (jobs.empty() || jobs.find_first_not_of("0123456789") != std::string::npos) {
+        LOG(ERROR) << "[MAIN] Invalid number of jobs in " << arg;
+        exit(1);
+    }
+
+    return std::stoi(jobs);
+}
+
 int main(int argc, char *argv[]) {
     LOGCFG.headers = true;
     LOGCFG.level = INFO;
 
-    if (argc < 3) {
-        LOG(ERROR) << "Usage: papyrus <test file location> <output directory location>";
+    // Options are accepted anywhere on the command line
+    bool fused = false;
+    bool time_passes = false;
+    int parse_jobs = 1;
+    int jobs = 1;
+    int opt_level = -1;
+    std::vector<std::string> passes;
+    bool has_passes = false;
+    std::vector<char*> positional;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--fused") {
+            fused = true;
+        } else if (arg == "--time-passes") {
+            time_passes = true;
+        } else if (arg == "-O0" || arg == "-O1" || arg == "-O2") {
+            opt_level = arg[2] - '0';
+        } else if (arg.rfind("--passes=", 0) == 0) {
+            // Comma separated, run in the order given
+            std::string list = arg.substr(std::string("--passes=").size());
+            std::stringstream ss(list);
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                if (!PassManager::IsKnownPass(name)) {
+                    LOG(ERROR) << "[MAIN] Unknown pass " << name << " in " << arg;
+                    exit(1);
+                }
+                passes.push_back(name);
+            }
+            has_passes = true;
+        } else if (arg.rfind("--parse-jobs=", 0) == 0) {
+            parse_jobs = ParseJobs(arg);
+        } else if (arg.rfind("--jobs=", 0) == 0) {
+            jobs = ParseJobs(arg);
+        } else if (arg.rfind("-", 0) == 0) {
+            LOG(ERROR) << "[MAIN] Unknown option " << arg;
+            exit(1);
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+
+    if (positional.size() < 2) {
+        LOG(ERROR) << "Usage: papyrus [--fused] [--parse-jobs=N] [-O0|-O1|-O2] [--passes=a,b,...] [--time-passes] [--jobs=N] <test file location> <output directory location>";
+        exit(1);
+    }
+
+    if (fused && parse_jobs != 1) {
+        LOG(ERROR) << "[MAIN] --parse-jobs cannot be combined with --fused";
         exit(1);
     }
 
+    if (has_passes && opt_level != -1) {
+        LOG(ERROR) << "[MAIN] --passes cannot be combined with -O";
+        exit(1);
+    }
+
+    char* in_file = positional.at(0);
+    char* out_dir = positional.at(1);
+
     // Test file
-    std::filebuf fb;
-    if (!fb.open(argv[1], std::ios::in)) {
+    struct stat sb;
+    if (!(stat(in_file, &sb) == 0 && S_ISREG(sb.st_mode))) {
         LOG(ERROR) << "[MAIN] Could not open file!";
         return 0;
     }
 
-    struct stat sb;
-    if (!(stat(argv[2], &sb) == 0 && S_ISDIR(sb.st_mode))) {
+    if (!(stat(out_dir, &sb) == 0 && S_ISDIR(sb.st_mode))) {
         LOG(ERROR) << "[MAIN] Could not open directory for writing output!";
         return 0;
     }
 
-    Utils utils(argv[2]);
+    Utils utils(out_dir);
 
-    std::istream is(&fb);
-    Lexer lexer(is);
+    // The file is mapped into memory and lexed in place
+    Lexer lexer(in_file);
 
-    ASTConstructor astconst(lexer);
-    astconst.ConstructAST();
+    // FusedParser is an ASTConstructor which can also skip the AST
+    FusedParser parser(lexer);
+    IRConstructor irconst = IRConstructor(parser);
 
-    IRConstructor irconst = IRConstructor(astconst);
-    irconst.BuildIR();
-
-    ArrayLSRemover als(irconst);
-    als.Run();
+    if (fused) {
+        // Parse and construct the IR in a single pass
+        parser.BuildIR(irconst);
+    } else {
+        parser.SetParseJobs(parse_jobs);
+        parser.ConstructAST();
+        irconst.BuildIR();
+    }
 
-    // Disabled
-    // DCE dce(irconst);
-    // dce.Run();
+    PassManager pm(irconst);
+    pm.SetTimePasses(time_passes);
+    pm.SetJobs(jobs);
+    if (has_passes) {
+        for (const auto& name: passes) {
+            pm.AddPass(name);
+        }
+    } else {
+        pm.AddPipeline(opt_level == -1 ? 1 : opt_level);
+    }
+    pm.Run();
 
     Visualizer viz = Visualizer(irconst);
+    viz.SetJobs(jobs);
 
-    std::string ir_fname = utils.ConstructOutFile(argv[1], ".ir.vcg");
+    std::string ir_fname = utils.ConstructOutFile(in_file, ".ir.vcg");
     viz.WriteIR(ir_fname);
 
-    // Disabled
-    // IGBuilder igb(irconst);
-    // RegAllocator ra(irconst, igb);
-    // ra.Run();
-
-    // std::string final_fname = utils.ConstructOutFile(argv[1], ".ra.vcg");
-    // viz.UpdateColoring(ra.Coloring());
-    // viz.WriteFinalIR(final_fname);
+    // Only when regalloc is part of the pipeline
+    if (pm.GetRegAllocator() != nullptr) {
+        std::string final_fname = utils.ConstructOutFile(in_file, ".ra.vcg");
+        viz.UpdateColoring(pm.GetRegAllocator()->Coloring());
+        viz.WriteFinalIR(final_fname);
+    }
 
     return 0;
 }
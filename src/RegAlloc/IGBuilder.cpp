@@ -111,7 +111,7 @@ ClusterDS& InterferenceGraph::ClusterMembers() {
  */
 IGBuilder::IGBuilder(IRConstructor& irc) : 
     AnalysisPass(irc),
-    loop_depth_(0),
+    loops_(nullptr),
     ig_(*new InterferenceGraph()) {}
 
 void IGBuilder::AddInterference(VI source, VI dest) {
@@ -199,45 +199,14 @@ void IGBuilder::CoalesceNodes(const Function* fn) {
 
 void IGBuilder::ProcessBlock(const Function* fn, const BasicBlock* bb) {
     auto bb_idx = bb->Idx();
-    if (visited.find(bb_idx) != visited.end()) {
-        // Already visited this BB
-        return;
-    }
-
-    for (auto succ_idx: bb->Successors()) {
-        auto succ = fn->GetBB(succ_idx);
-
-        if (succ->Type() == B::BB_LOOPHEAD) {
-            if (fn->IsBackEdge(bb_idx, succ_idx)) {
-                // This implies we are at loop end
-                // Back edge found. Decide later.
-                continue;
-            } else {
-                loop_depth_++;
-                ProcessBlock(fn, succ);
-                loop_depth_--;
-            }
-        } else {
-            ProcessBlock(fn, succ);
-        }
-    }
-
     bb_live = {};
 
-    auto rev_ins_order = bb->InstructionOrder();
-
-    if (rev_ins_order.size() != 0) {
-        auto bb_from = rev_ins_order.front();
-        auto bb_end  = rev_ins_order.back();
-        std::reverse(rev_ins_order.begin(), rev_ins_order.end());
-    }
-
     for (auto succ_idx: bb->Successors()) {
         // Check if succ exists in bb_live_in
         // This should not happen since succ should be visited
         // before current block in PostOrderCFG
         auto succ = fn->GetBB(succ_idx);
-        auto succ_livein = bb_live_in[succ_idx];
+        const auto& succ_livein = bb_live_in[succ_idx];
 
         // Insert all live values at beginning of successor block
         // into current.
@@ -247,20 +216,19 @@ void IGBuilder::ProcessBlock(const Function* fn, const BasicBlock* bb) {
         for (auto ins_idx: succ->InstructionOrder()) {
             auto ins = fn->GetInstruction(ins_idx);
             if (ins->Type() == T::INS_PHI && ins->IsActive()) {
-                auto op_source = ins->OpSource();
-                if (op_source.find(bb_idx) != op_source.end()) {
+                auto val_idx = ins->OperandFrom(bb_idx);
+                if (val_idx != NO_VALUE) {
                     // Insert values flowing into successor phi from 
                     // current block.
-                    auto val_idx = op_source.at(bb_idx);
                     auto val = fn->GetValue(val_idx);
 
-                    bb_live.insert(op_source.at(bb_idx));
+                    bb_live.insert(val_idx);
                     // We need to ensure that the constant is also
                     // live at this time. That is when we would be 
                     // introducing moves.
                     //
                     // if (val->Type() != V::VAL_CONST) {
-                    //     bb_live.insert(op_source.at(bb_idx));
+                    //     bb_live.insert(val_idx);
                     // }
                 }
             } else if (ins->Type() != T::INS_PHI) {
@@ -270,7 +238,7 @@ void IGBuilder::ProcessBlock(const Function* fn, const BasicBlock* bb) {
         }
     }
 
-    for (auto ins_idx: rev_ins_order) {
+    for (auto ins_idx: bb->ReverseInstructionOrder()) {
         auto ins = fn->GetInstruction(ins_idx);
 
         // Do not process instruction if not active
@@ -282,7 +250,7 @@ void IGBuilder::ProcessBlock(const Function* fn, const BasicBlock* bb) {
         auto result = ins->Result();
 
         // Add depth to the result
-        fn->GetValue(result)->SetDepth(loop_depth_);
+        fn->Values().SetLoopDepth(result, loops_->LoopDepth(bb_idx));
         bb_live.erase(result);
 
         if (ins->Type() != T::INS_PHI) {
@@ -315,28 +283,28 @@ void IGBuilder::ProcessBlock(const Function* fn, const BasicBlock* bb) {
     }
 
     bb_live_in[bb_idx] = bb_live;
-    visited.insert(bb_idx);
 }
 
 void IGBuilder::Run() {
-    for (auto fn_pair: irc().Functions()) {
-        std::string fn_name = fn_pair.first;
+    for (const auto& fn_pair: irc().Functions()) {
+        const std::string& fn_name = fn_pair.first;
         if (irc().IsIntrinsic(fn_name)) {
             continue;
         }
 
         auto fn = fn_pair.second;
-        visited = {};
+
+        loops_ = &fn->Loops();
 
         //////////////////////////
         bb_live = {};
         bb_live_in = {};
         //////////////////////////
         
-        auto entry_idx = 1;
-        auto bb = fn->GetBB(entry_idx);
-
-        ProcessBlock(fn, bb);
+        // Successors first, so that their live-in sets are known
+        for (auto bb_idx: fn->ForwardPostOrder()) {
+            ProcessBlock(fn, fn->GetBB(bb_idx));
+        }
 
         live_in_vars_[fn_name] = bb_live_in;
 
@@ -48,6 +48,7 @@ public:
     IGBuilder(IRConstructor&);
 
     void Run();
+    PreservedAnalyses Preserved() const { return PRESERVE_ALL; }
     void AddInterference(VI, VI);
     void CreateNode(VI);
 
@@ -65,8 +66,8 @@ private:
 
     BBLiveIn bb_live_in;
     ValueSet bb_live;
-    std::unordered_set<BI> visited;
-    int loop_depth_;
+    // Loops of the function being processed
+    const LoopInfo* loops_;
 
     InterferenceGraph& ig_;
 };
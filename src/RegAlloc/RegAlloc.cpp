@@ -39,53 +39,39 @@ std::string ColorString(C col) {
     return s;
 }
 
-std::unordered_map<VI, Color> RegAllocator::Coloring() const {
+const std::unordered_map<VI, Color>& RegAllocator::Coloring() const {
     return coloring_;
 }
 
 VI Function::CreateMove(BI bb_idx, VI val_idx, int reg) {
     SetCurrentBB(bb_idx);
-    instruction_counter_++;
-
-    Instruction* inst = new Instruction(T::INS_MOVE, CurrentBBIdx(), instruction_counter_);
-
-    instruction_map_[instruction_counter_] = inst;
+    Instruction* inst = GetInstruction(NewInstruction(T::INS_MOVE));
 
     ///////////////////////////////////////////
     V vty = V::VAL_ANY;
-    auto val = new Value(vty);
 
-    value_counter_ = value_map_->size() + 1;
-    value_counter_++;
-    value_map_->emplace(value_counter_, val);
+    value_counter_ = value_map_->Create(vty);
     auto reg_idx = value_counter_;
     ///////////////////////////////////////////
 
-    auto back_ins = GetInstruction(instruction_order_.back());
-    if (back_ins->Type() == T::INS_BRA) {
-        auto temp = instruction_order_.back();
-        instruction_order_.pop_back();
-        instruction_order_.push_back(instruction_counter_);
-        instruction_order_.push_back(temp);
-    } else {
-        instruction_order_.push_back(instruction_counter_);
-    }
-
     CurrentInstruction()->AddOperand(val_idx);
     CurrentInstruction()->AddOperand(reg_idx);
 
     AddUsage(val_idx, instruction_counter_);
     AddUsage(reg_idx, instruction_counter_);
 
-    CurrentBB()->AddInstruction(instruction_counter_, inst);
+    // The move has to happen before the BB branches away
+    InstructionList& order = CurrentBB()->Instructions();
+    if (!order.Empty() && GetInstruction(order.Back())->Type() == T::INS_BRA) {
+        order.InsertBefore(order.Back(), instruction_counter_);
+    } else {
+        order.PushBack(instruction_counter_);
+    }
 
     //////////////////////////////////////////
     vty = V::VAL_ANY;
-    val = new Value(vty);
 
-    value_counter_ = value_map_->size() + 1;
-    value_counter_++;
-    value_map_->emplace(value_counter_, val);
+    value_counter_ = value_map_->Create(vty);
     auto result = value_counter_;
     inst->SetResult(result);
     ///////////////////////////////////////////
@@ -95,9 +81,9 @@ VI Function::CreateMove(BI bb_idx, VI val_idx, int reg) {
 
 BI Instruction::FindSource(VI val_idx) const {
     BI found = -1;
-    for (auto bb_pair: op_source_) {
-        if (bb_pair.second == val_idx) {
-            found = bb_pair.first;
+    for (std::size_t i = 0; i < sources_.size(); i++) {
+        if (operands_[i] == val_idx) {
+            found = sources_[i];
             break;
         }
     }
@@ -106,8 +92,8 @@ BI Instruction::FindSource(VI val_idx) const {
 }
 
 void RegAllocator::AnnotateIR() {
-    for (auto fn_pair: irc().Functions()) {
-        auto fn_name = fn_pair.first;
+    for (const auto& fn_pair: irc().Functions()) {
+        const auto& fn_name = fn_pair.first;
 
         if (irc().IsIntrinsic(fn_name)) {
             continue;
@@ -125,7 +111,7 @@ void RegAllocator::AnnotateIR() {
                     // Phi handling
 
                     // Make Phi Inactive
-                    ins->MakeInactive();
+                    fn->RemoveInstruction(ins_idx);
 
                     auto arg_1  = ins->Operands().at(0);
                     auto arg_2  = ins->Operands().at(1);
@@ -197,19 +183,18 @@ void RegAllocator::CalculateSpillCosts() {
             coloring_.at(val_idx) > NUM_REG) {
 
             // SpillCost calculation : 10^(loop_depth) / Degree
-            auto val = irc().GetValue(val_idx);
-            auto depth  = val->LoopDepth();
+            auto depth  = irc().Values().LoopDepth(val_idx);
             auto degree = neighbors.size();
 
             cost = pow(10, depth) / (degree * 1.0);
-            val->SetSpillCost(cost);
+            irc().Values().SetSpillCost(val_idx, cost);
             
             spill_costs_.push_back({val_idx, cost});
         }
     }
 }
 
-C RegAllocator::GetColor(std::unordered_set<VI>& neighbors) {
+C RegAllocator::GetColor(const std::unordered_set<VI>& neighbors) {
     Color c;
     auto avail_colors(colors_);
     for (auto neighbor: neighbors) {
@@ -232,24 +217,24 @@ void RegAllocator::ColorIG() {
     // Let us first color clusters. The thought process behind this is that
     // the values inside a cluster are a part of the Phi and hence
     // we should color them with the same color ideally to remove it.
-    for (auto cluster_pair: IG().ClusterNeighbors()) {
-        auto cluster_neighbors = cluster_pair.second;
+    for (const auto& cluster_pair: IG().ClusterNeighbors()) {
+        const auto& cluster_neighbors = cluster_pair.second;
 
         auto c = GetColor(cluster_neighbors);
         
         auto cluster_id = cluster_pair.first;
-        auto cluster_members = IG().ClusterMembers()[cluster_id];
+        const auto& cluster_members = IG().ClusterMembers()[cluster_id];
 
         for (auto member: cluster_members) {
             coloring_[member] = c;
         }
     }
 
-    for (auto val_pair: ig_map_) {
+    for (const auto& val_pair: ig_map_) {
         auto val_idx = val_pair.first;
 
         if (coloring_.find(val_idx) == coloring_.end()) {
-            auto neighbors = val_pair.second;
+            const auto& neighbors = val_pair.second;
             auto c = GetColor(neighbors);
 
             coloring_[val_idx] = c;
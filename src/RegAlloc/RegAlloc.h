@@ -37,7 +37,10 @@ public:
     RegAllocator(IRConstructor&, IGBuilder&);
     void Run();
 
-    std::unordered_map<VI, Color> Coloring() const;
+    // Moves are inserted into existing BBs
+    PreservedAnalyses Preserved() const { return PRESERVE_CFG | ANALYSIS_CALL_GRAPH; }
+
+    const std::unordered_map<VI, Color>& Coloring() const;
 
 private:
     IGBuilder& igb_;
@@ -45,7 +48,7 @@ private:
     inline InterferenceGraph& IG() { return igb().IG(); }
     inline IGMap& GetIGMap() { return igb().GetIG(); }
 
-    Color GetColor(std::unordered_set<VI>&);
+    Color GetColor(const std::unordered_set<VI>&);
 
     void TryColoringSpilledVals();
     void CalculateSpillCosts();
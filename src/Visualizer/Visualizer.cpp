@@ -1,5 +1,7 @@
 #include "Visualizer.h"
 
+#include "Papyrus/ThreadPool.h"
+
 using namespace papyrus;
 
 using V = Value::ValueType;
@@ -71,7 +73,8 @@ std::string Function::ConvertValueToString(VI val_idx) const {
 }
 
 Visualizer::Visualizer(IRC& irc) :
-    irc_(irc) {}
+    irc_(irc),
+    jobs_(1) {}
 
 void Visualizer::UpdateColoring(const std::unordered_map<VI, Color>& coloring) {
     coloring_ = coloring;
@@ -170,7 +173,7 @@ std::string Visualizer::ConvertInstructionToString(const Function* fn, II ins_id
     return res;
 }
 
-void Visualizer::DrawFunc(const Function* func) {
+std::string Visualizer::FuncGraph(const Function* func) const {
     std::string func_name = func->FunctionName();
 
     std::string bb_graph = "";
@@ -201,17 +204,47 @@ void Visualizer::DrawFunc(const Function* func) {
         }
     }
 
-    graph_ << bb_graph;
+    return bb_graph;
+}
+
+void Visualizer::DrawFunc(const Function* func) {
+    graph_ << FuncGraph(func);
 }
 
 void Visualizer::UpdateVCG() {
-    std::string func_name;
-    for (auto func_pair: irc_.Functions()) {
-        func_name = func_pair.first;
-        if (!irc_.IsIntrinsic(func_name)) {
-            DrawFunc(func_pair.second);
+    if (jobs_ == 1) {
+        for (const auto& func_pair: irc_.Functions()) {
+            const std::string& func_name = func_pair.first;
+            if (!irc_.IsIntrinsic(func_name)) {
+                DrawFunc(func_pair.second);
+            }
+        }
+        return;
+    }
+
+    // Draw the functions in parallel, then write them out in the same order
+    // as above
+    std::vector<const Function*> funcs;
+    for (const auto& func_pair: irc_.Functions()) {
+        if (!irc_.IsIntrinsic(func_pair.first)) {
+            funcs.push_back(func_pair.second);
         }
     }
+
+    std::vector<std::string> graphs(funcs.size());
+    {
+        ThreadPool pool(jobs_);
+        for (std::size_t i = 0; i < funcs.size(); i++) {
+            pool.Submit([this, &funcs, &graphs, i] {
+                graphs[i] = FuncGraph(funcs[i]);
+            });
+        }
+        pool.Wait();
+    }
+
+    for (const auto& graph: graphs) {
+        graph_ << graph;
+    }
 }
 
 
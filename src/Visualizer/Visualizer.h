@@ -27,7 +27,11 @@ public:
 
     void UpdateColoring(const std::unordered_map<VI, Color>&);
 
+    // Functions are drawn on this many threads, 0 for one per core
+    void SetJobs(unsigned jobs) { jobs_ = jobs; }
+
     void DrawFunc(const Function*);
+    std::string FuncGraph(const Function*) const;
 
     std::string GetBaseNodeString(BI, const std::string&) const;
 
@@ -58,6 +62,8 @@ private:
 
     // Store register coloring in the Visualizer instance
     std::unordered_map<VI, Color> coloring_;
+
+    unsigned jobs_;
 };
 
 } // namespace papyrus
@@ -0,0 +1,79 @@
+#include "FrontEnd/ASTConstructor.h"
+#include "FrontEnd/Lexer.h"
+#include "IR/IRConstructor.h"
+
+#include <cstdio>
+#include <unordered_set>
+
+using namespace papyrus;
+
+structlog LOGCFG = {};
+
+// Every BB reachable from the entry has to be placed exactly once
+static bool CheckPostOrder(const std::string& name, Function* fn) {
+    const auto& postorder = fn->PostOrderCFG();
+    std::size_t num_reachable = fn->Dominators().ReversePostOrder().size();
+
+    std::unordered_set<BI> placed;
+    for (auto bb_idx: postorder) {
+        if (!placed.insert(bb_idx).second) {
+            std::printf("%s: BB_%d is placed twice\n", name.c_str(), bb_idx);
+            return false;
+        }
+    }
+
+    if (postorder.size() != num_reachable) {
+        std::printf("%s: post order has %zu BBs, %zu are reachable\n",
+                    name.c_str(), postorder.size(), num_reachable);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Checks the cached post order of a CFG A -> {B, C}, C -> B, where B is
+ * reached again through C before it is walked from A, and then of each
+ * function of the given files.
+ *
+ * usage: cfg_order_test [file...]
+ */
+int main(int argc, char** argv) {
+    LOGCFG.level = ERROR;
+
+    {
+        ValueTable values;
+        Function fn("cfg", NO_VALUE, &values);
+
+        BI a = 1;
+        BI b = fn.CreateBB(B::BB_THROUGH);
+        BI c = fn.CreateBB(B::BB_THEN);
+        fn.AddBBEdge(a, b);
+        fn.AddBBEdge(a, c);
+        fn.AddBBEdge(c, b);
+
+        if (!CheckPostOrder("cfg", &fn)) {
+            return 1;
+        }
+    }
+
+    for (int i = 1; i < argc; i++) {
+        Lexer lexer{std::string(argv[i])};
+        ASTConstructor astconst(lexer);
+        astconst.ConstructAST();
+
+        IRConstructor irc(astconst);
+        irc.BuildIR();
+
+        for (const auto& fn_pair: irc.Functions()) {
+            if (irc.IsIntrinsic(fn_pair.first)) {
+                continue;
+            }
+            if (!CheckPostOrder(fn_pair.first, fn_pair.second)) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "FrontEnd/ASTConstructor.h"
+#include "FrontEnd/Lexer.h"
+#include "IR/IRConstructor.h"
+#include "IR/LoopInfo.h"
+
+#include <algorithm>
+#include <cstdio>
+
+using namespace papyrus;
+
+structlog LOGCFG = {};
+
+/*
+ * Splits every edge into a loop header, the back edges included, then checks
+ * that each phi takes exactly one operand from each predecessor of its BB.
+ * Loop headers may begin with kills, which come before their phis.
+ *
+ * usage: split_edge_test <file>
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: split_edge_test <file>\n");
+        return 1;
+    }
+
+    LOGCFG.level = ERROR;
+
+    Lexer lexer{std::string(argv[1])};
+    ASTConstructor astconst(lexer);
+    astconst.ConstructAST();
+
+    IRConstructor irc(astconst);
+    irc.BuildIR();
+
+    for (const auto& fn_pair: irc.Functions()) {
+        if (irc.IsIntrinsic(fn_pair.first)) {
+            continue;
+        }
+        Function* fn = fn_pair.second;
+
+        std::vector<std::pair<BI, BI> > edges;
+        for (const auto& bb_pair: fn->BasicBlocks()) {
+            if (!fn->Loops().IsHeader(bb_pair.first)) {
+                continue;
+            }
+            for (auto pred: bb_pair.second->Predecessors()) {
+                edges.push_back({pred, bb_pair.first});
+            }
+        }
+
+        for (const auto& edge: edges) {
+            fn->SplitEdge(edge.first, edge.second);
+        }
+
+        for (const auto& bb_pair: fn->BasicBlocks()) {
+            const auto& preds = bb_pair.second->Predecessors();
+
+            for (auto ins_idx: bb_pair.second->InstructionOrder()) {
+                Instruction* ins = fn->GetInstruction(ins_idx);
+                if (!ins->IsPhi()) {
+                    continue;
+                }
+
+                for (auto pred: preds) {
+                    const auto& sources = ins->Sources();
+                    if (std::count(sources.begin(), sources.end(), pred) != 1) {
+                        std::printf("%s: phi %d of BB_%d has no single operand from BB_%d\n",
+                                    fn_pair.first.c_str(), ins_idx, bb_pair.first, pred);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,19 @@
+#!/bin/sh
+# Compiles a program without any passes, and fails if the IR has a phi whose
+# operands are all the same value. Such phis are to be removed while the SSA
+# form is constructed.
+#
+# usage: no_trivial_phis.sh <papyrus> <work directory> <input>
+set -e
+
+PAPYRUS=$1
+WORK=$2
+INPUT=$3
+NAME=$(basename "$INPUT" .txt)
+
+mkdir -p "$WORK"
+"$PAPYRUS" -O0 "$INPUT" "$WORK" > "$WORK/$NAME.log" 2>&1
+
+if grep -E 'φ (\S+)( \1)+ *$' "$WORK/$NAME.ir.vcg"; then
+    exit 1
+fi
@@ -0,0 +1,26 @@
+#!/bin/sh
+# Generates a program with bench/gen_program.py and compiles it. The log of
+# papyrus is only shown if it fails. If STACK_KIB is set, papyrus runs with
+# its stack limited to that many KiB.
+#
+# usage: stress.sh <papyrus> <work directory> <kind> <args...>
+set -e
+
+PAPYRUS=$1
+WORK=$2
+shift 2
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+NAME=$(echo "$@" | tr ' ' '_')
+
+mkdir -p "$WORK"
+python3 "$ROOT/bench/gen_program.py" "$@" > "$WORK/$NAME.txt"
+if ! (
+    if [ -n "$STACK_KIB" ]; then
+        ulimit -s "$STACK_KIB"
+    fi
+    exec "$PAPYRUS" "$WORK/$NAME.txt" "$WORK"
+) > "$WORK/$NAME.log" 2>&1; then
+    tail -n 20 "$WORK/$NAME.log"
+    exit 1
+fi